@@ -9,9 +9,11 @@
 #include <map>
 #include <vector>
 
+#include "structure/forwarding_table.h"
 #include "structure/packet.h"
 #include "structure/routing.h"
 #include "structure/types.h"
+#include "structure/via_index.h"
 
 namespace simulation {
 
@@ -25,7 +27,7 @@ class DistanceVectorRouting final : public Routing {
 
   struct CostWithNeighbor {
     Cost cost;
-    Node *via_node;
+    NodeID via_node;
   };
 
   using RoutingTable = std::map<Address, CostWithNeighbor>;
@@ -40,35 +42,51 @@ class DistanceVectorRouting final : public Routing {
 
   // Update the neighbors in the routing table. Remove all neighbor from
   // table_ and add new ones at 1 hop distance.
-  void UpdateNeighbors(Env &env,
-                       const std::set<Node *> &current_neighbors) override;
+  void UpdateNeighbors(Env &env, const std::vector<NodeID> &added,
+                       const std::vector<NodeID> &removed) override;
 
   Node *Route(Env &env, Packet &packet) override;
 
-  void Process(Env &env, Packet &packet, Node *from_node) override;
+  void Process(Env &env, Packet &packet, NodeID from_node) override;
 
-  void SendUpdate(Env &env, Node *neighbor) override;
+  void SendUpdate(Env &env, NodeID neighbor) override;
 
   std::size_t GetRecordsCount() const override { return table_.size(); }
 
   void UpdateAddresses() override;
 
+  // Neighbors keep their routes to withdrawn addresses until the link to them
+  // breaks since updates only add or improve routes.
+  void WithdrawAddresses(Env &env,
+                         const std::vector<Address> &addresses) override;
+
  private:
   static constexpr Cost MAX_COST = 15;
   static constexpr Cost NEIGHBOR_COST = 1;
   static constexpr Cost MIN_COST = 0;
 
-  bool AddRecord(UpdateTable::const_iterator update_it, Node *via_neighbor);
+  bool AddRecord(UpdateTable::const_iterator update_it, NodeID via_neighbor);
 
   // Updates this with information form other RoutingTable incomming from
   // neighbor.
   // RETURNS: true if change has occured, false otherwise
-  bool UpdateRouting(const UpdateTable &update, Node *from_node);
+  bool UpdateRouting(const UpdateTable &update, NodeID from_node);
+
+  // RETURNS: fib_, compiled again if table_ has changed since.
+  const ForwardingTable &GetForwardingTable();
 
   void CreateUpdateMirror();
 
+  // Routing information base, all packets are routed by fib_ compiled from it
+  // once it changes before the next packet is routed.
   RoutingTable table_;
 
+  ForwardingTable fib_;
+  bool fib_outdated_ = false;
+
+  // Records of table_ grouped by the neighbor they are routed through.
+  ViaIndex<RoutingTable::iterator> via_index_;
+
   UpdateTable update_mirror_;
 };
 
@@ -19,6 +19,9 @@ class AddressGenerator {
   virtual std::unique_ptr<AddressGenerator> Clone() = 0;
 };
 
+// Generates all addresses of one component, then all addresses of two
+// components and so on, so address length grows logarithmically with the
+// number of nodes.
 class SequentialAddressGenerator final : public AddressGenerator {
  public:
   std::pair<Address, bool> Next(Position) {
@@ -34,12 +37,17 @@ class SequentialAddressGenerator final : public AddressGenerator {
 
  private:
   void GenerateNext() {
-    if (next_address_.empty() ||
-        next_address_.back() == std::numeric_limits<unsigned char>::max()) {
-      next_address_.push_back(0);
-    } else {
-      ++next_address_.back();
+    // Increment the address as a number with the carry propagated to the
+    // front, extend it once all its components overflow.
+    for (auto i = next_address_.end(); i != next_address_.begin();) {
+      --i;
+      if (*i != std::numeric_limits<AddressComponent>::max()) {
+        ++*i;
+        return;
+      }
+      *i = 0;
     }
+    next_address_.push_back(0);
   }
 
   Address next_address_;
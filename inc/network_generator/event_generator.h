@@ -6,11 +6,14 @@
 #define SARP_NETWORK_GENERATOR_EVENT_GENERATOR_H_
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "network_generator/position_generator.h"
 #include "network_generator/time_generator.h"
 #include "structure/event.h"
+#include "structure/flow.h"
+#include "structure/link_trace.h"
 #include "structure/network.h"
 #include "structure/node.h"
 #include "structure/position.h"
@@ -64,6 +67,18 @@ class SpecificTrafficGenerator final : public EventGenerator {
   range<NodeID> to_;
 };
 
+// Creates one FlowEvent for each flow at the start of the flow.
+class FlowGenerator final : public EventGenerator {
+ public:
+  FlowGenerator(std::vector<Flow> flows, Network &network);
+
+  std::unique_ptr<Event> Next() override;
+
+ private:
+  std::vector<Flow> flows_;
+  Network &network_;
+};
+
 class NeighborUpdateGenerator final : public EventGenerator {
  public:
   NeighborUpdateGenerator(range<Time> time, Time period, Network &nodes);
@@ -110,6 +125,21 @@ class NodeGenerator final : public EventGenerator {
   std::unique_ptr<AddressGenerator> address_generator_;
 };
 
+// Streams changes of links of the network topology from a LinkTrace. It
+// generates a single LinkEvent which reads the trace as the simulation time
+// advances, so the changes are not all scheduled up front. Throws
+// std::runtime_error if the trace can not be read, see LinkTrace.
+class LinkEventGenerator final : public EventGenerator {
+ public:
+  LinkEventGenerator(const std::string &path, Network &network);
+
+  std::unique_ptr<Event> Next() override;
+
+ private:
+  std::unique_ptr<LinkTrace> trace_;
+  Network &network_;
+};
+
 class ReaddressEventGenerator final : public EventGenerator {
  public:
   ReaddressEventGenerator(range<Time> time, Time period, Network &nodes);
@@ -5,11 +5,15 @@
 #ifndef SARP_NETWORK_GENERATOR_POSITION_GENERATOR_H_
 #define SARP_NETWORK_GENERATOR_POSITION_GENERATOR_H_
 
+#include <cstdint>
 #include <fstream>
 #include <memory>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include "structure/position.h"
+#include "structure/thread_pool.h"
 #include "structure/types.h"
 
 namespace simulation {
@@ -21,9 +25,33 @@ class PositionGenerator {
   virtual std::unique_ptr<PositionGenerator> Clone() = 0;
 };
 
+// Generates given positions in order. Positions are immutable and shared
+// between clones so even large loaded topologies are cloned in constant time.
 class FinitePositionGenerator final : public PositionGenerator {
  public:
-  FinitePositionGenerator(const std::vector<Position> &positions);
+  using PositionContainer = std::shared_ptr<const std::vector<Position>>;
+
+  // Parses lines of .dot file in format: name [ pos="x,y,z" ], other lines
+  // are skipped.
+  static std::vector<Position> ParseDot(std::string_view text);
+
+  // Loads positions from memory mapped .dot file or from binary file written
+  // by WriteBinaryFile. Throws std::runtime_error if the file can not be
+  // opened, nothing is loaded if its content is not valid.
+  static std::unique_ptr<FinitePositionGenerator> FromDotFile(
+      const std::string &path);
+  static std::unique_ptr<FinitePositionGenerator> FromBinaryFile(
+      const std::string &path);
+
+  // Writes positions in binary format: 8 byte magic "SARPPOS1", 8 byte count
+  // and then x, y and z of each position as 4 byte integers in native byte
+  // order.
+  // RETURNS: false on failure.
+  static bool WriteBinaryFile(const std::string &path,
+                              const std::vector<Position> &positions);
+
+  FinitePositionGenerator(std::vector<Position> positions);
+  FinitePositionGenerator(PositionContainer positions);
   FinitePositionGenerator(std::ifstream &is);
   ~FinitePositionGenerator() override = default;
 
@@ -33,7 +61,7 @@ class FinitePositionGenerator final : public PositionGenerator {
 
  private:
   std::size_t i = 0;
-  std::vector<Position> positions_;
+  PositionContainer positions_;
 };
 
 class RandomPositionGenerator : public PositionGenerator {
@@ -49,6 +77,131 @@ class RandomPositionGenerator : public PositionGenerator {
   range<Position> boundaries_;
 };
 
+// Base of generators which compute positions on the fly from their index in
+// a fixed sequence of candidates instead of storing them. Candidates are
+// independent of each other so any range of them can be generated separately,
+// see GeneratePositions, and clones start from the first one.
+class ProceduralPositionGenerator : public PositionGenerator {
+ public:
+  ProceduralPositionGenerator(std::size_t candidate_count);
+  ~ProceduralPositionGenerator() override = default;
+
+  // RETURNS: position of given candidate and false if the candidate is
+  // rejected by the generator, safe to call concurrently.
+  virtual std::pair<Position, bool> At(std::size_t index) const = 0;
+
+  // RETURNS: position of the next accepted candidate.
+  std::pair<Position, bool> Next() override;
+
+  std::size_t get_candidate_count() const { return candidate_count_; }
+
+ protected:
+  // RETURNS: random number determined by the seed and the keys.
+  static uint64_t Hash(uint64_t seed, uint64_t key1, uint64_t key2 = 0);
+
+  // RETURNS: number in [from, to) determined by the hash.
+  static int HashToRange(uint64_t hash, int from, int to);
+
+ private:
+  std::size_t candidate_count_;
+  std::size_t next_ = 0;
+};
+
+// Lattice of x * y * z positions spaced by given distance. Positions are
+// ordered by x, then by y and then by z.
+class GridPositionGenerator final : public ProceduralPositionGenerator {
+ public:
+  GridPositionGenerator(unsigned x, unsigned y, unsigned z, uint32_t spacing,
+                        Position origin = Position(0, 0, 0));
+  ~GridPositionGenerator() override = default;
+
+  std::pair<Position, bool> At(std::size_t index) const override;
+
+  std::unique_ptr<PositionGenerator> Clone() override;
+
+ private:
+  unsigned x_, y_, z_;
+  uint32_t spacing_;
+  Position origin_;
+};
+
+// Given count of positions spread uniformly in the boundaries. Unlike
+// RandomPositionGenerator positions depend only on the seed.
+class UniformPositionGenerator final : public ProceduralPositionGenerator {
+ public:
+  UniformPositionGenerator(range<Position> boundaries, std::size_t count,
+                           uint64_t seed);
+  ~UniformPositionGenerator() override = default;
+
+  // RETURNS: cube starting at the origin in which count nodes spread
+  // uniformly have on average given number of nodes in connection range.
+  static range<Position> GetDensityBoundaries(std::size_t count,
+                                              uint32_t connection_range,
+                                              double neighbors);
+
+  std::pair<Position, bool> At(std::size_t index) const override;
+
+  std::unique_ptr<PositionGenerator> Clone() override;
+
+ private:
+  range<Position> boundaries_;
+  uint64_t seed_;
+};
+
+// Random positions in the boundaries no closer to each other than
+// min_distance. The boundaries are divided to cubes with side min_distance,
+// each cube has one random candidate which is accepted if all candidates
+// closer than min_distance in neighboring cubes have lower priority. So the
+// candidate count is the cube count and only part of them is accepted.
+class PoissonDiskPositionGenerator final : public ProceduralPositionGenerator {
+ public:
+  PoissonDiskPositionGenerator(range<Position> boundaries,
+                               uint32_t min_distance, uint64_t seed);
+  ~PoissonDiskPositionGenerator() override = default;
+
+  std::pair<Position, bool> At(std::size_t index) const override;
+
+  std::unique_ptr<PositionGenerator> Clone() override;
+
+ private:
+  // RETURNS: candidate of given cube.
+  Position GetCandidate(int x, int y, int z) const;
+
+  // RETURNS: priority of the candidate of given cube, unique for each cube.
+  uint64_t GetPriority(int x, int y, int z) const;
+
+  range<Position> boundaries_;
+  uint32_t min_distance_;
+  uint64_t seed_;
+  int cubes_x_, cubes_y_, cubes_z_;
+};
+
+// Given count of positions in clusters with random centers in the boundaries.
+// Position i belongs to cluster i % cluster_count and is spread uniformly in
+// the ball with cluster_radius around its center, clipped to the boundaries.
+class ClusteredPositionGenerator final : public ProceduralPositionGenerator {
+ public:
+  ClusteredPositionGenerator(range<Position> boundaries, std::size_t count,
+                             std::size_t cluster_count, uint32_t cluster_radius,
+                             uint64_t seed);
+  ~ClusteredPositionGenerator() override = default;
+
+  std::pair<Position, bool> At(std::size_t index) const override;
+
+  std::unique_ptr<PositionGenerator> Clone() override;
+
+ private:
+  range<Position> boundaries_;
+  std::size_t cluster_count_;
+  uint32_t cluster_radius_;
+  uint64_t seed_;
+};
+
+// Generates accepted positions of the generator in order of their candidates,
+// ranges of candidates are generated in parallel on the thread pool.
+std::vector<Position> GeneratePositions(
+    const ProceduralPositionGenerator &generator, ThreadPool &thread_pool);
+
 }  // namespace simulation
 
 #endif  // SARP_NETWORK_GENERATOR_POSITION_GENERATOR_H_
@@ -5,10 +5,10 @@
 #ifndef SARP_SARP_COST_H_
 #define SARP_SARP_COST_H_
 
+#include <cassert>
 #include <cmath>
-#include <numeric>
+#include <cstddef>
 #include <ostream>
-#include <vector>
 
 namespace simulation {
 
@@ -29,27 +29,6 @@ struct Cost {
 
   Cost(double mean, double variance) : mean_(mean), variance_(variance) {}
 
-  Cost(const std::vector<Cost> &costs) {
-    if (costs.size() == 1) {
-      mean_ = costs[0].mean_;
-      variance_ = costs[0].variance_;
-      return;
-    }
-    auto SumMeans = [](double sum_accumulator, const Cost &c) {
-      return sum_accumulator + c.mean_;
-    };
-    double sum_means =
-        std::accumulate(costs.cbegin(), costs.cend(), 0.0, SumMeans);
-    mean_ = sum_means / costs.size();
-
-    auto ComputeVarianceSum = [this](double sum_accumulator, const Cost &c) {
-      return sum_accumulator + pow2(c.mean_ - mean_) + pow2(c.variance_);
-    };
-    double variance_sum =
-        std::accumulate(costs.cbegin(), costs.cend(), 0.0, ComputeVarianceSum);
-    variance_ = variance_sum / costs.size();
-  }
-
   static Cost AddCosts(const Cost &c1, const Cost &c2) {
     return Cost(c1.mean_ + c2.mean_, c1.variance_ + c2.variance_);
   }
@@ -88,6 +67,47 @@ struct Cost {
   double variance_;
 };
 
+// Generalized cost of a group of routes added one by one. Its mean is the mean
+// of their means and its variance the variance of their means plus the mean
+// of their squared variances, the cost of a single route is kept as it is.
+class CostAccumulator final {
+ public:
+  void Add(const Cost &cost) {
+    if (count_ == 0) {
+      first_ = cost;
+    }
+    ++count_;
+    sum_means_ += cost.Mean();
+    // Deviations from the first mean keep the variance accurate when means
+    // are large and close to each other.
+    const double deviation = cost.Mean() - first_.Mean();
+    sum_deviations_ += deviation;
+    sum_squared_deviations_ += pow2(deviation);
+    sum_squared_variances_ += pow2(cost.Variance());
+  }
+
+  std::size_t Count() const { return count_; }
+
+  Cost Get() const {
+    assert(count_ > 0);
+    if (count_ == 1) {
+      return first_;
+    }
+    const double variance_sum = sum_squared_deviations_ -
+                                pow2(sum_deviations_) / count_ +
+                                sum_squared_variances_;
+    return Cost(sum_means_ / count_, variance_sum / count_);
+  }
+
+ private:
+  std::size_t count_ = 0;
+  Cost first_;
+  double sum_means_ = 0;
+  double sum_deviations_ = 0;
+  double sum_squared_deviations_ = 0;
+  double sum_squared_variances_ = 0;
+};
+
 bool operator==(const Cost &lhs, const Cost &rhs);
 
 bool operator!=(const Cost &lhs, const Cost &rhs);
@@ -0,0 +1,29 @@
+//
+// digest.h
+//
+
+#ifndef SARP_SARP_DIGEST_H_
+#define SARP_SARP_DIGEST_H_
+
+#include <bit>
+#include <cstdint>
+
+#include "sarp/cost.h"
+#include "structure/hash.h"
+
+namespace simulation {
+
+// Hash of a set of SARP records, used to skip those which did not change.
+using Digest = uint64_t;
+
+// RETURNS: digest of the exact bits of the cost.
+inline Digest CostDigest(const Cost &cost) {
+  // The offset tells a record of zero cost from no record.
+  return Mix64(Mix64(std::bit_cast<uint64_t>(cost.Mean()) +
+                     0x9e3779b97f4a7c15ULL) +
+               std::bit_cast<uint64_t>(cost.Variance()));
+}
+
+}  // namespace simulation
+
+#endif  // SARP_SARP_DIGEST_H_
@@ -5,14 +5,40 @@
 #ifndef SARP_SARP_GLOBAL_ADDRESS_UPDATE_H_
 #define SARP_SARP_GLOBAL_ADDRESS_UPDATE_H_
 
+#include <memory>
+#include <vector>
+
 #include "network_generator/event_generator.h"
+#include "structure/address.h"
 #include "structure/event.h"
+#include "structure/types.h"
 
 namespace simulation {
 
+// Octree cells of the nodes at the last addressing, shared by the events of one
+// generator so that nodes which stay in their cell reuse their address.
+struct OctreeCells {
+  struct Entry {
+    NodeID node;
+    // Morton code of the cell, no_code if the address was not computed from it.
+    uint64_t code;
+    Address address;
+  };
+  static constexpr uint64_t no_code = ~uint64_t(0);
+
+  std::size_t depth = 0;
+  // Indexed by the position in the boot order.
+  std::vector<Entry> entries;
+};
+
+// Assigns each node the address of its octree cell. With address_lifetime the
+// addresses of cells the node has left are removed once they are not assigned
+// to it again for that long, otherwise nodes keep all their addresses.
 class OctreeAddressingEvent final : public Event {
  public:
-  OctreeAddressingEvent(const Time time, TimeType type, Network &network);
+  OctreeAddressingEvent(const Time time, TimeType type, Network &network,
+                        Time address_lifetime = 0,
+                        std::shared_ptr<OctreeCells> cells = nullptr);
   ~OctreeAddressingEvent() override = default;
 
   void Execute(Env &env) override;
@@ -25,15 +51,24 @@ class OctreeAddressingEvent final : public Event {
   int get_priority() const override { return 90; }
 
  private:
-  void RecomputeUniqueAddresses(Network &, Position min_pos, Position max_pos);
+  void RecomputeUniqueAddresses(const Parameters &parameters, Network &,
+                                Time time);
+
+  // Removes addresses of all nodes which were last assigned at or before
+  // given time.
+  void ExpireAddresses(Env &env, Time time);
 
   Network &network_;
+  Time address_lifetime_;
+  std::shared_ptr<OctreeCells> cells_;
 };
 
 class OctreeAddressingEventGenerator final : public EventGenerator {
  public:
+  // Addresses expire after address_lifetime periods, 0 means never.
   OctreeAddressingEventGenerator(range<Time> time, Time period,
-                                 Network &network);
+                                 Network &network,
+                                 std::size_t address_lifetime = 0);
 
   ~OctreeAddressingEventGenerator() override = default;
 
@@ -43,7 +78,9 @@ class OctreeAddressingEventGenerator final : public EventGenerator {
   range<Time> time_;
   Time period_;
   Network &network_;
+  std::size_t address_lifetime_;
   Time virtual_time_;
+  std::shared_ptr<OctreeCells> cells_;
 };
 
 }  // namespace simulation
@@ -5,8 +5,12 @@
 #ifndef SARP_SARP_ROUTING_H_
 #define SARP_SARP_ROUTING_H_
 
+#include <deque>
+#include <map>
+
 #include "sarp/cost.h"
 #include "sarp/sarp_table.h"
+#include "structure/forwarding_table.h"
 #include "structure/node.h"
 #include "structure/packet.h"
 #include "structure/routing.h"
@@ -16,6 +20,8 @@
 namespace simulation {
 
 class Parameters;
+class SarpDigestRequestPacket;
+class SarpDigestUpdatePacket;
 
 class SarpRouting final : public Routing {
   friend class CostTests;
@@ -31,19 +37,22 @@ class SarpRouting final : public Routing {
 
   // Update the neighbors in the routing table. Remove all neighbors from
   // working table and add new ones at 1 hop distance.
-  void UpdateNeighbors(Env &env,
-                       const std::set<Node *> &current_neighbors) override;
+  void UpdateNeighbors(Env &env, const std::vector<NodeID> &added,
+                       const std::vector<NodeID> &removed) override;
 
   Node *Route(Env &env, Packet &packet) override;
 
-  void Process(Env &env, Packet &packet, Node *from_node) override;
+  void Process(Env &env, Packet &packet, NodeID from_node) override;
 
-  void SendUpdate(Env &env, Node *neighbor) override;
+  void SendUpdate(Env &env, NodeID neighbor) override;
 
   std::size_t GetRecordsCount() const override { return table_.Size(); }
 
   void UpdateAddresses() override;
 
+  void WithdrawAddresses(Env &env,
+                         const std::vector<Address> &addresses) override;
+
   std::pair<Address, bool> SelectAddress(Env &env) const override;
 
   void Dump(std::ostream &os) const;
@@ -51,22 +60,92 @@ class SarpRouting final : public Routing {
  private:
   inline static const Cost MIN_COST{0, 0};
   inline static const Cost MAX_COST{std::numeric_limits<double>::max(), 0};
+  // Batches are rebuilt if more records than this ratio of the table have
+  // changed inputs, updating them one by one would take longer.
+  static constexpr double MAX_CHANGED_RATIO = 0.25;
 
   void InsertInitialAddress(Address address, const Cost &cost);
 
-  bool BatchProcessUpdate(const Parameters::Sarp &parameters);
+  // Replaces table_ by a table built from the latest updates of all
+  // neighbors and addresses of the node.
+  // RETURNS: true if the change is worth sending an update.
+  bool BatchProcessUpdate(const Parameters::Sarp &parameters,
+                          AddressPool &pool);
+
+  // Builds the table of the batch from scratch, tables before Generalize and
+  // Compact are kept for UpdateBatch if requested.
+  bool RebuildBatch(const Parameters::Sarp &parameters, AddressPool &pool,
+                    bool keep_tables);
+
+  // RETURNS: distinct addresses whose records in the latest updates or local
+  // records differ from those of the last batch.
+  std::vector<AddressID> FindChangedAddresses(AddressPool &pool) const;
+
+  // Changes the tables of the last batch only at given sorted changed
+  // addresses, the result is the same as of RebuildBatch.
+  bool UpdateBatch(const Parameters::Sarp &parameters, AddressPool &pool,
+                   const std::vector<Address> &changed);
 
   bool NeedUpdate(const SarpTable &new_table, double update_treshold) const;
 
-  void CreateUpdateMirror();
+  // RETURNS: fib_, compiled again if table_ has changed since.
+  const ForwardingTable &GetForwardingTable();
+
+  void CreateUpdateMirror(const Parameters::Sarp &parameters,
+                          AddressPool &pool);
 
+  // In the digest exchange the request is a packet carrying the digest of the
+  // update held from the neighbor, see Parameters::Sarp::digest_exchange.
+  void RequestUpdate(Env &env, NodeID neighbor) override;
+
+  // Replies to the request with changes of update_mirror_ since the update
+  // held by the neighbor if it is kept, with all records otherwise.
+  void SendDigestUpdate(Env &env, Digest held_digest, NodeID neighbor);
+
+  // Sets the update held from the neighbor from a packet of the exchange.
+  // RETURNS: false if the packet does not apply to the update held.
+  bool ReceiveDigestUpdate(const SarpDigestUpdatePacket &packet,
+                           NodeID from_node, const AddressPool &pool);
+
+  // Registers the routing packet and schedules its receive on the neighbor.
+  void SendToNeighbor(Env &env, NodeID neighbor,
+                      std::unique_ptr<Packet> packet);
+
+  // Routing information base, edited and rebuilt by batches of updates.
   SarpTable table_;
 
+  // Compiled from table_ once it changes before the next packet is routed,
+  // all packets are routed by it.
+  ForwardingTable fib_;
+  bool fib_outdated_ = false;
+
   SarpUpdate update_mirror_;
 
+  // Digest exchange, see Parameters::Sarp::digest_exchange. Previous values
+  // of update_mirror_ are kept to send neighbors holding them only changes.
+  struct PublishedUpdate {
+    Digest digest;
+    SarpUpdate update;
+  };
+  Digest mirror_digest_ = 0;
+  std::deque<PublishedUpdate> published_updates_;  // The oldest first.
+  // Digests of the latest updates received from neighbors.
+  std::map<NodeID, Digest> held_digests_;
+
   // Keep history of incomming update packets to compare against.
   std::size_t neighbor_count_ = 0;
-  std::map<Node *, SarpUpdate> last_updates_;
+  std::map<NodeID, SarpUpdate> last_updates_;
+
+  // Inputs of the last batch and its table before Generalize and Compact.
+  std::map<NodeID, SarpUpdate> batch_updates_;
+  Node::AddressContainerType batch_addresses_;
+  SarpTable merged_;
+  SarpTable generalized_;
+  // False if the tables above have not been kept or table_ has been changed
+  // since the last batch, then the next one is rebuilt.
+  bool batch_valid_ = false;
+  // Result of the last batch.
+  bool batch_changed_ = true;
 };
 
 }  // namespace simulation
@@ -5,86 +5,380 @@
 #ifndef SARP_SARP_TABLE_H_
 #define SARP_SARP_TABLE_H_
 
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <limits>
 #include <map>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #include "sarp/cost.h"
+#include "sarp/digest.h"
+#include "structure/address_pool.h"
+#include "structure/forwarding_table.h"
 #include "structure/node.h"
 #include "structure/types.h"
 
 namespace simulation {
 
-using SarpUpdate = std::map<Address, Cost>;
+// Records of a table in order of their addresses as they are sent to
+// neighbors. Addresses are interned, so copies of updates for each neighbor
+// copy only ids and costs.
+struct SarpUpdateRecord {
+  AddressID address;
+  Cost cost;
+};
+
+using SarpUpdate = std::vector<SarpUpdateRecord>;
+
+// Routing table of SARP stored as a trie of address components. Trie nodes
+// live in one arena and refer to each other by index, nodes of erased records
+// are reused. Children with components lower than FANOUT are indexed directly,
+// the others are kept in a list sorted by component, so any components work
+// but FANOUT should cover the ones in use. Records are iterated in
+// lexicographic order of their addresses, i.e. in preorder of the trie.
+template <std::size_t FANOUT>
+class BasicSarpTable final {
+  using Index = uint32_t;
+
+  template <bool IS_CONST>
+  class Iterator;
 
-class SarpTable final {
  public:
-  struct CostWithNeighbor {
+  struct Record {
+    Address address;
     Cost cost;
-    Node *via_node;
+    NodeID via_node;
   };
 
-  using Data = std::map<Address, CostWithNeighbor>;
-  using iterator = Data::iterator;
-  using const_iterator = Data::const_iterator;
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  BasicSarpTable();
 
-  const_iterator cbegin() const { return data_.cbegin(); }
+  const_iterator cbegin() const { return {this, FirstRecord()}; }
 
-  const_iterator cend() const { return data_.cend(); }
+  const_iterator cend() const { return {this, NONE}; }
 
-  iterator begin() { return data_.begin(); }
+  iterator begin() { return {this, FirstRecord()}; }
 
-  iterator end() { return data_.end(); }
+  iterator end() { return {this, NONE}; }
 
   bool Contains(const Address &address) const {
-    return data_.contains(address);
+    return Find(address) != cend();
   }
 
+  // RETURNS: the record with given address and true if it was inserted.
   std::pair<iterator, bool> Insert(const Address &address, const Cost &cost,
-                                   Node *via_node) {
-    return data_.insert({address, {.cost = cost, .via_node = via_node}});
-  }
+                                   NodeID via_node);
+
+  // RETURNS: iterator to the record following the erased one.
+  iterator Erase(iterator record);
 
-  iterator Erase(iterator record) { return data_.erase(record); }
+  // Removes all records routed through given neighbor.
+  void EraseVia(NodeID via_node);
 
-  iterator Find(const Address &address) { return data_.find(address); }
+  // Sets the record of the address, inserts it if there is none.
+  // RETURNS: true if the record has changed.
+  bool Assign(const Address &address, const Cost &cost, NodeID via_node);
+
+  iterator Find(const Address &address) {
+    const Index index = FindNode(address);
+    return {this, IsRecord(index) ? index : NONE};
+  }
 
   const_iterator Find(const Address &address) const {
-    return data_.find(address);
+    return const_cast<BasicSarpTable *>(this)->Find(address);
   }
 
-  std::size_t Size() const { return data_.size(); }
+  std::size_t Size() const { return size_; }
 
-  void AddRecord(const Address &address, const Cost &cost, Node *via_neighbor,
-                 Node const *reflexive_via_node);
+  // RETURNS: the record of the address or else the first record among those
+  // sharing the longest prefix with it, unless a later one not routed through
+  // the reflexive node has lower cost, then the first of the lowest. That is
+  // the outcome of scanning records in order, but the best record of each
+  // subtree is cached, so it takes O(depth) once the cache is filled.
+  const_iterator FindBestMatch(const Address &address,
+                               NodeID reflexive_via_node) const;
 
-  void Generalize(Node const *reflexive_via_node);
+  // RETURNS: forwarding table with an entry for each prefix of the records,
+  // its lookups give the via nodes of FindBestMatch.
+  ForwardingTable CompileForwardingTable(NodeID reflexive_via_node) const;
 
+  void AddRecord(const Address &address, const Cost &cost, NodeID via_neighbor,
+                 NodeID reflexive_via_node);
+
+  // Sets each record which has children with records and all of whose
+  // prefixes have records to the generalized cost of the children, routed
+  // through their most frequent via node other than the reflexive one.
+  void Generalize(NodeID reflexive_via_node);
+
+  // Removes records below each record with redundant children.
   void Compact(double compact_treshold, double min_standard_deviation);
 
-  bool NeedUpdate(const SarpTable &new_table, double difference_treshold,
+  // Same as Generalize followed by Compact in a single pass.
+  void GeneralizeAndCompact(NodeID reflexive_via_node, double compact_treshold,
+                            double min_standard_deviation);
+
+  // RETURNS: true if a record of new_table is missing in this or its cost
+  // differs by more than the treshold. Subtrees with equal digests are
+  // skipped, so equal tables take O(1) once digests are computed.
+  bool NeedUpdate(const BasicSarpTable &new_table, double difference_treshold,
                   double ratio_variance_treshold) const;
 
-  SarpUpdate CreateUpdate() const;
+  SarpUpdate CreateUpdate(AddressPool &pool) const;
+
+  // Brings this, merged after Generalize, up to date once records of merged
+  // at given sorted addresses have changed. Only those records, their
+  // prefixes and subtrees of inserted or erased records are generalized again.
+  // RETURNS: sorted addresses of records of this which have changed.
+  std::vector<Address> Regeneralize(const BasicSarpTable &merged,
+                                    const std::vector<Address> &changed,
+                                    NodeID reflexive_via_node);
+
+  // Brings this, generalized after Compact, up to date once records of
+  // generalized at given sorted addresses have changed. Subtrees are copied
+  // again only where records appear, disappear or start or stop compacting.
+  // RETURNS: NeedUpdate of the result against this before.
+  bool Recompact(const BasicSarpTable &generalized,
+                 const std::vector<Address> &changed, double compact_treshold,
+                 double min_standard_deviation, double difference_treshold);
 
   std::pair<Address, bool> FindFreeSubtreeAddress(
       const_iterator root, range<AddressComponent> component_range) const;
 
  private:
-  std::vector<iterator> GetDirectChildren(iterator record);
+  static constexpr Index NONE = std::numeric_limits<Index>::max();
+  static constexpr Index ROOT = 0;  // Node of the empty address.
 
-  bool HasRedundantChildren(iterator record, double compact_treshold,
-                            double min_standard_deviation);
+  struct TrieNode {
+    Record record;
+    bool has_record = false;
+    Index parent = NONE;
+    std::array<Index, FANOUT> children;
+    Index overflow_children = NONE;  // First child with component >= FANOUT.
+    Index next_overflow = NONE;  // Next child of the parent in that list.
+    // Doubly linked list of records routed through the same neighbor.
+    Index via_previous = NONE;
+    Index via_next = NONE;
+    // Record of the subtree with the lowest cost not routed through the
+    // reflexive node, see BestRecord.
+    mutable Index best = NONE;
+    mutable bool best_valid = false;
+    // Digest of the subtree, see SubtreeDigest.
+    mutable bool digest_valid = false;  // Fits in padding after best_valid.
+    mutable Digest digest = 0;
+  };
+
+  // Records of the children of a node to be generalized, added one by one.
+  class ChildrenSummary {
+   public:
+    void Add(const Record &record, NodeID reflexive_via_node);
 
-  iterator RemoveSubtree(iterator record);
+    bool Empty() const { return costs_.Count() == 0; }
 
-  Node *GetMostFrequentNeighbor(const std::vector<iterator> &children,
-                                Node const *reflexive_via_node);
+    Cost GetCost() const { return costs_.Get(); }
 
-  void GeneralizeRecursive(iterator record, Node const *reflexive_via_node);
+    // RETURNS: the via node of the only child, otherwise the most frequent
+    // one other than the reflexive node, the lowest of those on ties.
+    NodeID GetViaNode(NodeID reflexive_via_node) const;
 
-  Data data_;
+   private:
+    struct ViaCount {
+      NodeID via_node;
+      std::size_t count;
+    };
+
+    CostAccumulator costs_;
+    NodeID first_via_node_ = 0;
+    // Children of a node have at most FANOUT distinct via nodes unless they
+    // have components outside of FANOUT, those go to the map.
+    std::array<ViaCount, FANOUT> via_counts_;
+    std::size_t via_counts_size_ = 0;
+    std::map<NodeID, std::size_t> more_via_counts_;
+  };
+
+  // Node on the path of GeneralizeBottomUp.
+  struct PathNode {
+    Index index;
+    bool generalizes;  // Node and all of its ancestors have records.
+    ChildrenSummary children;
+    Digest children_digest;  // Of the children finished so far.
+  };
+
+  template <bool IS_CONST>
+  class Iterator {
+    friend class BasicSarpTable;
+    friend class Iterator<!IS_CONST>;
+    using Table =
+        std::conditional_t<IS_CONST, const BasicSarpTable, BasicSarpTable>;
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Record;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IS_CONST, const Record *, Record *>;
+    using reference = std::conditional_t<IS_CONST, const Record &, Record &>;
+
+    Iterator() = default;
+
+    // Mutable iterators convert to constant ones.
+    operator Iterator<true>() const { return {table_, index_}; }
+
+    reference operator*() const { return table_->nodes_[index_].record; }
+
+    pointer operator->() const { return &**this; }
+
+    Iterator &operator++() {
+      index_ = table_->NextRecord(index_);
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    bool operator==(const Iterator &other) const {
+      return index_ == other.index_;
+    }
+
+   private:
+    Iterator(Table *table, Index index) : table_(table), index_(index) {}
+
+    Table *table_ = nullptr;
+    Index index_ = NONE;
+  };
+
+  bool IsRecord(Index index) const {
+    return index != NONE && nodes_[index].has_record;
+  }
+
+  // RETURNS: node of the address or NONE if there is none.
+  Index FindNode(const Address &address) const;
+
+  Index FindChild(Index parent, AddressComponent component) const;
+
+  // RETURNS: child of the parent with given component, creates it if needed.
+  Index GetChild(Index parent, AddressComponent component);
+
+  Index FirstChild(Index index) const;
+
+  Index NextSibling(Index index) const;
+
+  // RETURNS: first node after the subtree of given node in preorder.
+  Index SkipSubtree(Index index) const;
+
+  Index FirstRecord() const {
+    return nodes_[ROOT].has_record ? ROOT : NextRecord(ROOT);
+  }
+
+  // RETURNS: next node with a record in preorder or NONE.
+  Index NextRecord(Index index) const;
+
+  // RETURNS: first node with a record after the subtree of given node.
+  Index NextRecordAfterSubtree(Index index) const;
+
+  // RETURNS: next node of the subtree of root in preorder or NONE, children of
+  // the node are skipped if requested.
+  Index NextInSubtree(Index index, Index root, bool skip_children) const;
+
+  Index AllocateNode(Index parent, const Address &address);
+
+  // Clears the record of the node and removes the node and its ancestors
+  // which have neither records nor children.
+  void ClearRecord(Index index);
+
+  // Removes the node and its ancestors if they have neither records nor
+  // children.
+  void Prune(Index index);
+
+  // Frees all descendants of the node.
+  void FreeDescendants(Index index);
+
+  void EraseSubtree(Index index);
+
+  void LinkVia(Index index);
+
+  void UnlinkVia(Index index);
+
+  bool HasRedundantChildren(Index index, double compact_treshold,
+                            double min_standard_deviation) const;
+
+  ChildrenSummary SummarizeChildren(Index index,
+                                    NodeID reflexive_via_node) const;
+
+  // Visits nodes in preorder and finishes each one once the traversal leaves
+  // its subtree, so children are generalized before their parents and
+  // compacting a record frees only records which are done.
+  void GeneralizeBottomUp(NodeID reflexive_via_node, bool compact,
+                          double compact_treshold,
+                          double min_standard_deviation);
+
+  // RETURNS: true if Generalize reaches the node, i.e. all its ancestors other
+  // than the root have records.
+  bool IsGeneralized(Index index) const;
+
+  // Sets the record of the address as Generalize would, children of the node
+  // have to be up to date.
+  // RETURNS: true if the record has changed.
+  bool RegeneralizeRecord(const BasicSarpTable &merged, const Address &address,
+                          NodeID reflexive_via_node);
+
+  // RETURNS: true if Compact removes the address, i.e. a record of one of its
+  // prefixes has redundant children.
+  bool IsCompactedAway(const Address &address, double compact_treshold,
+                       double min_standard_deviation) const;
+
+  // Copies the subtree of the address from generalized as Compact would.
+  // RETURNS: NeedUpdate of the copied records against the previous ones.
+  bool ReplaceSubtree(const BasicSarpTable &generalized, const Address &address,
+                      double compact_treshold, double min_standard_deviation,
+                      double difference_treshold);
+
+  static bool CostNeedsUpdate(const Cost &old_cost, const Cost &new_cost,
+                              double difference_treshold) {
+    return std::abs(Cost::ZScore(old_cost, new_cost)) > difference_treshold;
+  }
+
+  void SetViaNode(Index index, NodeID via_node);
+
+  // RETURNS: best match of FindBestMatch among records of the subtree, which
+  // have the longest prefix in common with addresses lacking a deeper node.
+  Index MatchInSubtree(Index index, NodeID reflexive_via_node) const;
+
+  // RETURNS: the first record of the subtree with the lowest cost among those
+  // not routed through the reflexive node or NONE, computes it if invalid.
+  Index BestRecord(Index index, NodeID reflexive_via_node) const;
+
+  // RETURNS: digest of addresses and exact costs of the records of the
+  // subtree, 0 only if it has no records. Computes it if invalid.
+  Digest SubtreeDigest(Index index) const;
+
+  bool NeedUpdateSubtree(Index index, const BasicSarpTable &new_table,
+                         Index new_index, double difference_treshold) const;
+
+  // Invalidates cached best records and digests of the node and its
+  // ancestors. Once a node is invalid so are all its ancestors, so it stops
+  // at the first one with both invalid.
+  void InvalidateCaches(Index index);
+
+  std::vector<TrieNode> nodes_;
+  std::vector<Index> free_nodes_;
+  std::size_t size_ = 0;
+  // First record of the list of records routed through each neighbor.
+  std::unordered_map<NodeID, Index> via_heads_;
+  // Reflexive node the cached best records were computed for.
+  mutable NodeID best_reflexive_via_node_ = 0;
 };
 
+// Components of octree addresses are 0 - 7, see octree.cc.
+using SarpTable = BasicSarpTable<8>;
+
 }  // namespace simulation
 
 #endif  // SARP_SARP_TABLE_H_
@@ -7,6 +7,8 @@
 
 #include <cstdint>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "sarp/routing.h"
 #include "structure/packet.h"
@@ -29,6 +31,57 @@ class SarpUpdatePacket final : public Packet {
   SarpUpdate update_;
 };
 
+// Request of the digest exchange. It carries the digest of the update held
+// from the neighbor, 0 if there is none.
+class SarpDigestRequestPacket final : public Packet {
+ public:
+  SarpDigestRequestPacket(Address sender_address, Address destination_address,
+                          Digest held_digest)
+      : Packet(sender_address, destination_address, PacketType::ROUTING,
+               sizeof(Digest)),
+        held_digest_(held_digest) {}
+
+  ~SarpDigestRequestPacket() override = default;
+
+  Digest get_held_digest() const { return held_digest_; }
+
+ private:
+  Digest held_digest_;
+};
+
+// Reply of the digest exchange. It carries records which are new or differ
+// from the update with the base digest and addresses of records removed
+// since, all sorted by addresses. The base digest 0 stands for no records.
+class SarpDigestUpdatePacket final : public Packet {
+ public:
+  SarpDigestUpdatePacket(Address sender_address, Address destination_address,
+                         Digest base_digest, Digest digest, SarpUpdate changed,
+                         std::vector<AddressID> removed)
+      : Packet(sender_address, destination_address, PacketType::ROUTING,
+               2 * sizeof(Digest) + changed.size() * sizeof(Cost) +
+                   removed.size() * sizeof(AddressID)),
+        base_digest_(base_digest),
+        digest_(digest),
+        changed_(std::move(changed)),
+        removed_(std::move(removed)) {}
+
+  ~SarpDigestUpdatePacket() override = default;
+
+  Digest get_base_digest() const { return base_digest_; }
+
+  Digest get_digest() const { return digest_; }
+
+  const SarpUpdate &get_changed() const { return changed_; }
+
+  const std::vector<AddressID> &get_removed() const { return removed_; }
+
+ private:
+  Digest base_digest_;
+  Digest digest_;
+  SarpUpdate changed_;
+  std::vector<AddressID> removed_;
+};
+
 }  // namespace simulation
 
 #endif  // SARP_SARP_UPDATE_PACKET_H_
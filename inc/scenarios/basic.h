@@ -5,7 +5,9 @@
 #ifndef SARP_SCENARIOS_BASIC_H_
 #define SARP_SCENARIOS_BASIC_H_
 
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "network_generator/event_generator.h"
@@ -66,6 +68,35 @@ std::tuple<Parameters, std::unique_ptr<Network>,
 MobileCube(RoutingType routing,
            Parameters::Sarp sarp_parameters = Parameters::Sarp());
 
+// Random nodes moving between random destinations with random speeds and
+// pauses, so the results depend on the order of the random draws of the plans.
+std::tuple<Parameters, std::unique_ptr<Network>,
+           std::vector<std::unique_ptr<EventGenerator>>>
+RandomMobileCube(RoutingType routing,
+                 Parameters::Sarp sarp_parameters = Parameters::Sarp());
+
+// Layouts of nodes of the LargeScale scenario.
+enum class Layout { GRID, UNIFORM, POISSON_DISK, CLUSTERED };
+
+// Static network of 100k-1M nodes for scaling benchmarks. Nodes are placed by
+// a procedural generator in a cube of size such that on average 10 nodes are
+// in connection range of each node, their positions depend only on the seed.
+// With POISSON_DISK layout the node count is only approximate.
+std::tuple<Parameters, std::unique_ptr<Network>,
+           std::vector<std::unique_ptr<EventGenerator>>>
+LargeScale(RoutingType routing, std::size_t node_count, Layout layout,
+           uint64_t seed = 1, unsigned worker_threads = 1,
+           Parameters::Sarp sarp_parameters = Parameters::Sarp());
+
+// Static network with links given by the topology instead of positions. Node
+// i of the topology boots as the i-th node. If link_events_path is not empty
+// link changes are read from it, see LinkEventGenerator.
+std::tuple<Parameters, std::unique_ptr<Network>,
+           std::vector<std::unique_ptr<EventGenerator>>>
+ExternalTopology(RoutingType routing, std::unique_ptr<Topology> topology,
+                 const std::string &link_events_path = "",
+                 Parameters::Sarp sarp_parameters = Parameters::Sarp());
+
 }  // namespace simulation
 
 #endif  // SARP_SCENARIOS_BASIC_H_
@@ -0,0 +1,184 @@
+//
+// address.h
+//
+
+#ifndef SARP_STRUCTURE_ADDRESS_H_
+#define SARP_STRUCTURE_ADDRESS_H_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <ostream>
+#include <stdexcept>
+
+namespace simulation {
+
+using AddressComponent = unsigned char;
+
+// Address of at most MAX_SIZE components stored inline, so copies do not
+// allocate. Components take one byte each in order, unused bytes are zero and
+// the last byte holds the size. Read as big endian words the bytes compare as
+// the components followed by the size, therefore addresses are ordered
+// lexicographically, like std::vector<AddressComponent>, by comparing WORDS
+// words. The interface follows std::vector where it is used.
+class Address final {
+ public:
+  static constexpr std::size_t MAX_SIZE = 31;
+
+  using value_type = AddressComponent;
+  using iterator = AddressComponent *;
+  using const_iterator = const AddressComponent *;
+
+  Address() = default;
+
+  // Address of given number of zero components.
+  explicit Address(std::size_t size) {
+    if (size > MAX_SIZE) {
+      throw std::length_error("Address exceeds MAX_SIZE components");
+    }
+    bytes_[MAX_SIZE] = size;
+  }
+
+  Address(std::initializer_list<AddressComponent> components)
+      : Address(components.begin(), components.end()) {}
+
+  template <typename Iterator>
+  Address(Iterator first, Iterator last) {
+    for (; first != last; ++first) {
+      push_back(*first);
+    }
+  }
+
+  friend bool operator==(const Address &a, const Address &b) {
+    for (std::size_t i = 0; i < WORDS; ++i) {
+      if (a.Word(i) != b.Word(i)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  friend std::strong_ordering operator<=>(const Address &a, const Address &b) {
+    for (std::size_t i = 0; i < WORDS; ++i) {
+      const uint64_t word_a = a.OrderedWord(i);
+      const uint64_t word_b = b.OrderedWord(i);
+      if (word_a != word_b) {
+        return word_a <=> word_b;
+      }
+    }
+    return std::strong_ordering::equal;
+  }
+
+  // RETURNS: number of leading components both addresses have in common.
+  std::size_t CommonPrefixLength(const Address &other) const {
+    const std::size_t max_length = std::min(size(), other.size());
+    for (std::size_t i = 0; i < WORDS; ++i) {
+      const uint64_t difference = OrderedWord(i) ^ other.OrderedWord(i);
+      if (difference != 0) {
+        const std::size_t common = std::countl_zero(difference) / 8;
+        return std::min(max_length, i * sizeof(uint64_t) + common);
+      }
+    }
+    return max_length;
+  }
+
+  std::size_t Hash() const {
+    uint64_t hash = 0;
+    for (std::size_t i = 0; i < WORDS; ++i) {
+      hash = (hash ^ Word(i)) * 0x9e3779b97f4a7c15;
+    }
+    return hash ^ (hash >> 32);
+  }
+
+  // Unlike the other bounds this is checked in release builds too, as callers
+  // prolonging addresses can reach the capacity.
+  void push_back(AddressComponent component) {
+    if (size() == MAX_SIZE) {
+      throw std::length_error("Address exceeds MAX_SIZE components");
+    }
+    bytes_[bytes_[MAX_SIZE]++] = component;
+  }
+
+  void pop_back() {
+    assert(!empty());
+    bytes_[--bytes_[MAX_SIZE]] = 0;
+  }
+
+  AddressComponent &back() {
+    assert(!empty());
+    return bytes_[size() - 1];
+  }
+
+  AddressComponent back() const {
+    assert(!empty());
+    return bytes_[size() - 1];
+  }
+
+  AddressComponent &operator[](std::size_t i) {
+    assert(i < size());
+    return bytes_[i];
+  }
+
+  AddressComponent operator[](std::size_t i) const {
+    assert(i < size());
+    return bytes_[i];
+  }
+
+  iterator begin() { return bytes_.data(); }
+
+  iterator end() { return bytes_.data() + size(); }
+
+  const_iterator begin() const { return bytes_.data(); }
+
+  const_iterator end() const { return bytes_.data() + size(); }
+
+  const_iterator cbegin() const { return begin(); }
+
+  const_iterator cend() const { return end(); }
+
+  std::size_t size() const { return bytes_[MAX_SIZE]; }
+
+  bool empty() const { return size() == 0; }
+
+ private:
+  static constexpr std::size_t WORDS = (MAX_SIZE + 1) / sizeof(uint64_t);
+
+  uint64_t Word(std::size_t i) const {
+    uint64_t word;
+    std::memcpy(&word, bytes_.data() + i * sizeof(uint64_t), sizeof(word));
+    return word;
+  }
+
+  // RETURNS: word whose most significant byte is the first one in memory.
+  uint64_t OrderedWord(std::size_t i) const {
+    if constexpr (std::endian::native == std::endian::little) {
+      return __builtin_bswap64(Word(i));
+    } else {
+      return Word(i);
+    }
+  }
+
+  alignas(uint64_t) std::array<AddressComponent, MAX_SIZE + 1> bytes_{};
+};
+
+static_assert(sizeof(Address) == Address::MAX_SIZE + 1);
+
+std::ostream &operator<<(std::ostream &os, const Address &addr);
+
+}  // namespace simulation
+
+template <>
+struct std::hash<simulation::Address> {
+  std::size_t operator()(const simulation::Address &address) const {
+    return address.Hash();
+  }
+};
+
+#endif  // SARP_STRUCTURE_ADDRESS_H_
@@ -0,0 +1,54 @@
+//
+// address_pool.h
+//
+
+#ifndef SARP_STRUCTURE_ADDRESS_POOL_H_
+#define SARP_STRUCTURE_ADDRESS_POOL_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "structure/address.h"
+
+namespace simulation {
+
+using AddressID = uint32_t;
+
+// Interns addresses of one simulation. Each distinct address gets a dense id
+// which never changes, so routing structures may hold 4 byte ids instead of
+// addresses. All prefixes of an interned address are interned as well and the
+// id of the parent, i.e. the address without its last component, is stored
+// with each address.
+class AddressPool final {
+ public:
+  // Id of the empty address, the root of all addresses.
+  static constexpr AddressID ROOT = 0;
+
+  AddressPool();
+
+  // RETURNS: id of the address, the address is added if it is new.
+  AddressID Intern(const Address &address);
+
+  const Address &Get(AddressID id) const {
+    assert(id < addresses_.size());
+    return addresses_[id];
+  }
+
+  // RETURNS: id of the address without its last component, ROOT for the root.
+  AddressID GetParent(AddressID id) const {
+    assert(id < parents_.size());
+    return parents_[id];
+  }
+
+  std::size_t Size() const { return addresses_.size(); }
+
+ private:
+  std::unordered_map<Address, AddressID> ids_;
+  std::vector<Address> addresses_;
+  std::vector<AddressID> parents_;
+};
+
+}  // namespace simulation
+
+#endif  // SARP_STRUCTURE_ADDRESS_POOL_H_
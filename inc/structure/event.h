@@ -7,8 +7,11 @@
 
 #include <iostream>
 #include <memory>
+#include <vector>
 
 #include "network_generator/position_generator.h"
+#include "structure/flow.h"
+#include "structure/link_trace.h"
 #include "structure/network.h"
 #include "structure/node.h"
 #include "structure/packet.h"
@@ -54,20 +57,30 @@ class Event {
   // Default is 0 but since int is used both directions are possible.
   virtual int get_priority() const { return 0; };
 
+  // Schedules the event again at given absolute time once Execute returns,
+  // i.e. repeating events are not reallocated.
+  void Repeat(Time time) {
+    time_ = time;
+    repeat_ = true;
+  }
+
   Time time_;
   const TimeType time_type_;
+
+ private:
+  bool repeat_ = false;
 };
 
 class SendEvent final : public Event {
  public:
   // Sends prepared packet from given sender node. Generally used for routing
   // updates.
-  SendEvent(Time time, TimeType time_type, Node &sender,
+  SendEvent(Time time, TimeType time_type, NodeID sender,
             std::unique_ptr<Packet> packet);
 
   // Sends new packet from sender to destination with given size. Used for non
   // routing related packets.
-  SendEvent(Time time, TimeType time_type, Node &sender, Node &destination,
+  SendEvent(Time time, TimeType time_type, NodeID sender, NodeID destination,
             uint32_t size);
 
   void Execute(Env &env) override;
@@ -75,15 +88,15 @@ class SendEvent final : public Event {
   std::ostream &Print(std::ostream &os) const override;
 
  private:
-  Node &sender_;
-  Node *destination_ = nullptr;
-  uint32_t size_;
+  NodeID sender_;
+  NodeID destination_ = 0;
+  uint32_t size_ = 0;
   std::unique_ptr<Packet> packet_ = nullptr;
 };
 
 class RecvEvent final : public Event {
  public:
-  RecvEvent(Time time, TimeType time_type, Node &sender, Node &reciever,
+  RecvEvent(Time time, TimeType time_type, NodeID sender, NodeID reciever,
             std::unique_ptr<Packet> packet);
 
   void Execute(Env &env) override;
@@ -96,8 +109,8 @@ class RecvEvent final : public Event {
   int get_priority() const override { return 90; }
 
  private:
-  Node &sender_;
-  Node &reciever_;
+  NodeID sender_;
+  NodeID reciever_;
   std::unique_ptr<Packet> packet_;
 };
 
@@ -128,10 +141,42 @@ class TrafficEvent final : public Event {
   NodeID to_;
 };
 
+// Sends packets of one flow. The event repeats itself for each packet until
+// the flow ends, so there is only one event per flow.
+class FlowEvent final : public Event {
+ public:
+  FlowEvent(Network &network, Flow flow);
+
+  void Execute(Env &env) override;
+
+  std::ostream &Print(std::ostream &os) const override;
+
+ private:
+  // RETURNS: node of the endpoint other than excluded node, nullptr if there
+  // is none booted.
+  Node *PickNode(const FlowEndpoint &endpoint,
+                 const std::vector<NodeID> &candidates, NodeID excluded);
+
+  // Finds nodes matching prefix endpoints, the candidates are refreshed once
+  // per routing update period since addresses do not change more often.
+  void UpdateCandidates(const Env &env);
+
+  // RETURNS: time of the next packet.
+  Time GetNextTime(Time now);
+
+  Network &network_;
+  Flow flow_;
+  std::size_t sent_ = 0;
+  Time on_end_ = 0;  // End of the current on period, 0 before the first one.
+  Time candidates_refresh_ = 0;
+  std::vector<NodeID> source_candidates_;
+  std::vector<NodeID> destination_candidates_;
+};
+
+// Moves one mobile node every step_period, see Mobility.
 class MoveEvent final : public Event {
  public:
-  MoveEvent(Time time, TimeType time_type, Network &network, Node &node,
-            std::unique_ptr<PositionGenerator> directions);
+  MoveEvent(Time time, TimeType time_type, Network &network, NodeID node);
 
   void Execute(Env &env) override;
 
@@ -143,11 +188,47 @@ class MoveEvent final : public Event {
   int get_priority() const override { return 80; }
 
  private:
-  bool AssignNewPlan(const Parameters &parameters);
+  Network &network_;
+  NodeID node_;
+};
+
+// Starts new segments of lazily moving nodes, see Mobility.
+class MobilityStepEvent final : public Event {
+ public:
+  MobilityStepEvent(Time time, TimeType time_type, Network &network);
+
+  void Execute(Env &env) override;
 
+  std::ostream &Print(std::ostream &os) const override;
+
+ protected:
+  // Make this priority higher than UpdateNeighbors since we want to know about
+  // new neighbors.
+  int get_priority() const override { return 80; }
+
+ private:
   Network &network_;
-  Node &node_;
-  std::unique_ptr<PositionGenerator> directions_;
+};
+
+// Applies all changes of links of the network topology which are due, see
+// Network::UpdateLink, and repeats itself at the time of the next change of
+// the trace.
+class LinkEvent final : public Event {
+ public:
+  LinkEvent(Time time, TimeType time_type, Network &network,
+            std::unique_ptr<LinkTrace> trace);
+
+  void Execute(Env &env) override;
+
+  std::ostream &Print(std::ostream &os) const override;
+
+ protected:
+  // Same as MobilityStepEvent, link changes happen before neighbor updates.
+  int get_priority() const override { return 80; }
+
+ private:
+  Network &network_;
+  std::unique_ptr<LinkTrace> trace_;
 };
 
 class UpdateNeighborsEvent final : public Event {
@@ -168,25 +249,26 @@ class UpdateNeighborsEvent final : public Event {
 
 class UpdateRoutingEvent final : public Event {
  public:
-  UpdateRoutingEvent(Time time, TimeType time_type, Routing &routing);
+  UpdateRoutingEvent(Time time, TimeType time_type, NodeID node);
 
   void Execute(Env &env) override;
   std::ostream &Print(std::ostream &os) const override;
 
  private:
-  Routing &routing_;
+  NodeID node_;
 };
 
 class RequestUpdateEvent final : public Event {
  public:
-  RequestUpdateEvent(Time time, TimeType time_type, Node *node, Node *neighbor);
+  RequestUpdateEvent(Time time, TimeType time_type, NodeID node,
+                     NodeID neighbor);
 
   void Execute(Env &env) override;
   std::ostream &Print(std::ostream &os) const override;
 
  private:
-  Node *node_;
-  Node *neighbor_;
+  NodeID node_;
+  NodeID neighbor_;
 };
 
 class BootEvent final : public Event {
@@ -0,0 +1,52 @@
+//
+// flow.h
+//
+
+#ifndef SARP_STRUCTURE_FLOW_H_
+#define SARP_STRUCTURE_FLOW_H_
+
+#include <cstdint>
+
+#include "structure/types.h"
+
+namespace simulation {
+
+// Endpoint of a flow, either a given node or a random node whose address
+// starts with the prefix, chosen for each packet.
+struct FlowEndpoint {
+  static FlowEndpoint FromNode(NodeID node) {
+    return {.is_node = true, .node = node};
+  }
+
+  static FlowEndpoint FromPrefix(Address prefix) {
+    return {.is_node = false, .prefix = std::move(prefix)};
+  }
+
+  bool is_node = true;
+  NodeID node = 0;
+  Address prefix;
+};
+
+// Data packets sent from source to destination during time_range. CBR flows
+// send a packet every interval, POISSON flows have exponentially distributed
+// gaps between packets with mean interval and ON_OFF flows send a packet every
+// interval during on periods. Lengths of on and off periods are exponentially
+// distributed with given means.
+struct Flow {
+  enum class Type { CBR, POISSON, ON_OFF };
+
+  Type type = Type::CBR;
+  FlowEndpoint source;
+  FlowEndpoint destination;
+  range<Time> time_range = {0, 0};
+  Time interval = 1;
+  Time mean_on = 0;
+  Time mean_off = 0;
+  uint32_t packet_size = 1;
+  // Flow ends after this many packets, 0 means no limit.
+  std::size_t packet_limit = 0;
+};
+
+}  // namespace simulation
+
+#endif  // SARP_STRUCTURE_FLOW_H_
@@ -0,0 +1,68 @@
+//
+// forwarding_table.h
+//
+
+#ifndef SARP_STRUCTURE_FORWARDING_TABLE_H_
+#define SARP_STRUCTURE_FORWARDING_TABLE_H_
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "structure/address.h"
+#include "structure/types.h"
+
+namespace simulation {
+
+// Immutable forwarding table compiled by a routing from its routing table.
+// Each entry is an address with the next hop for packets to exactly that
+// address and the next hop for other packets whose longest matching prefix it
+// is, both precomputed by the routing. Addresses are kept sorted in a flat
+// array apart from the hops, so a lookup is a binary search followed by a
+// climb along links to the nearest entry which is a prefix of each entry.
+class ForwardingTable final {
+ public:
+  // There is no route.
+  static constexpr NodeID NO_HOP = std::numeric_limits<NodeID>::max();
+
+  struct Entry {
+    Address address;
+    NodeID exact_hop;
+    NodeID prefix_hop;
+  };
+
+  struct Match {
+    NodeID via_node;
+    bool exact;  // The via node is the exact hop of the address.
+  };
+
+  // Table without any routes.
+  ForwardingTable() = default;
+
+  // Entries must be sorted by their addresses and unique.
+  explicit ForwardingTable(const std::vector<Entry> &entries);
+
+  // RETURNS: the exact hop of the address if there is one, the prefix hop of
+  // its longest matching prefix otherwise, NO_HOP if there is neither.
+  Match Lookup(const Address &address) const;
+
+  std::size_t Size() const { return addresses_.size(); }
+
+ private:
+  using Index = uint32_t;
+
+  static constexpr Index NONE = std::numeric_limits<Index>::max();
+
+  struct Hops {
+    Index parent;  // Nearest entry with a prefix of the address.
+    NodeID exact_hop;
+    NodeID prefix_hop;
+  };
+
+  std::vector<Address> addresses_;
+  std::vector<Hops> hops_;
+};
+
+}  // namespace simulation
+
+#endif  // SARP_STRUCTURE_FORWARDING_TABLE_H_
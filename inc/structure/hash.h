@@ -0,0 +1,21 @@
+//
+// hash.h
+//
+
+#ifndef SARP_STRUCTURE_HASH_H_
+#define SARP_STRUCTURE_HASH_H_
+
+#include <cstdint>
+
+namespace simulation {
+
+// Finalizer of splitmix64, it is a bijection.
+inline uint64_t Mix64(uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+}  // namespace simulation
+
+#endif  // SARP_STRUCTURE_HASH_H_
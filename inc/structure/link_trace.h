@@ -0,0 +1,59 @@
+//
+// link_trace.h
+//
+
+#ifndef SARP_STRUCTURE_LINK_TRACE_H_
+#define SARP_STRUCTURE_LINK_TRACE_H_
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+#include "structure/types.h"
+
+namespace simulation {
+
+// Streams changes of links of a topology from a text file with lines in format:
+// time + node1 node2 [delivery_duration] to connect the nodes or
+// time - node1 node2 to disconnect them, other lines are skipped. Changes have
+// to be ordered by time, only the next one is kept in memory.
+class LinkTrace final {
+ public:
+  struct Change {
+    Time time = 0;
+    NodeID node1 = 0;
+    NodeID node2 = 0;
+    bool connected = false;
+    Time delivery_duration = 0;
+  };
+
+  // Throws std::runtime_error if the file can not be opened, or naming the
+  // line if a change does not have two ids less than node_count or is not
+  // ordered by time.
+  LinkTrace(const std::string &path, std::size_t node_count);
+
+  LinkTrace(const LinkTrace &) = delete;
+  LinkTrace &operator=(const LinkTrace &) = delete;
+
+  // RETURNS: next change or nullptr at the end of the trace, the change is
+  // valid until the next call of Pop.
+  const Change *Peek() const { return has_next_ ? &next_ : nullptr; }
+
+  // Moves to the next change.
+  void Pop();
+
+ private:
+  // RETURNS: true if the line contains a change, stores it to next_.
+  bool ParseLine(const std::string &line);
+
+  std::string path_;
+  std::ifstream is_;
+  std::size_t node_count_;
+  std::size_t line_number_ = 0;
+  bool has_next_ = false;
+  Change next_;
+};
+
+}  // namespace simulation
+
+#endif  // SARP_STRUCTURE_LINK_TRACE_H_
@@ -0,0 +1,35 @@
+//
+// mapped_file.h
+//
+
+#ifndef SARP_STRUCTURE_MAPPED_FILE_H_
+#define SARP_STRUCTURE_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace simulation {
+
+// Read only memory mapping of a whole file.
+class MappedFile final {
+ public:
+  // Throws std::runtime_error if the file can not be opened or mapped, so that
+  // a wrong path does not pass for an empty input.
+  MappedFile(const std::string &path);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  std::string_view get_view() const { return {data_, size_}; }
+
+ private:
+  const char *data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+}  // namespace simulation
+
+#endif  // SARP_STRUCTURE_MAPPED_FILE_H_
@@ -0,0 +1,126 @@
+//
+// mobility.h
+//
+
+#ifndef SARP_STRUCTURE_MOBILITY_H_
+#define SARP_STRUCTURE_MOBILITY_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "network_generator/position_generator.h"
+#include "structure/mobility_trace.h"
+#include "structure/position.h"
+#include "structure/types.h"
+
+namespace simulation {
+
+struct Env;
+class Network;
+class Parameters;
+
+// Moves all mobile nodes of the network. Each node has its own MoveEvent which
+// steps it by step_period, they draw new plans from Parameters::Movement in the
+// order of the schedule so that a seed gives the same trajectories whatever
+// else is scheduled at the same time. Plans are kept in one vector indexed by
+// NodeID.
+// With Parameters::Movement::lazy_positions nodes are not stepped at all. Each
+// node keeps the segment of its plan, i.e. the start time, origin, destination
+// and speed, and its position is computed from it only when it is needed.
+// Then a MobilityStepEvent is executed only at the end of segments to assign
+// new plans.
+// With Parameters::Movement::trace the segments are given by waypoints of the
+// trace instead, nodes move lazily and a MobilityStepEvent is executed at the
+// time of each waypoint. The trace is read as the simulation time advances.
+class Mobility final {
+ public:
+  Mobility(Network &network) : network_(network) {}
+
+  // Starts moving the node one routing update period after now. If directions
+  // is nullptr the node uses a clone of Parameters::Movement::directions.
+  void AddNode(Env &env, NodeID node,
+               std::unique_ptr<PositionGenerator> directions);
+
+  // Moves the node by step_period, gives it a new plan first if it has none.
+  // RETURNS: false if the node does not move anymore.
+  bool Move(Env &env, NodeID node);
+
+  // Starts new segments of lazily moving nodes whose segments have ended or
+  // whose waypoints are due.
+  void Step(Env &env);
+
+  // Sets positions of all lazily moving nodes to the ones at current time.
+  void UpdatePositions(Env &env);
+
+  // Sets position of a lazily moving node to the one at current time.
+  void UpdatePosition(Env &env, NodeID node);
+
+ private:
+  // Straight move from origin to destination followed by a pause.
+  struct Segment {
+    Time start = 0;
+    Time arrival = 0;
+    Position origin;
+    Position destination;
+    double speed = 0;  // m/s
+    Time evaluated = 0;  // Time of the last position evaluation.
+    std::unique_ptr<PositionGenerator> directions = nullptr;
+  };
+
+  // RETURNS: true if positions are computed from segments.
+  static bool IsLazy(const Parameters &parameters);
+
+  static bool IsTrace(const Parameters &parameters);
+
+  // RETURNS: position on the segment at given time, no sooner than the start
+  // and no later than the arrival.
+  static Position EvaluateSegment(const Segment &segment, Time time);
+
+  void StepLazy(Env &env);
+
+  // Applies all waypoints of the trace which are due.
+  void StepTrace(Env &env);
+
+  // Starts a new segment of the node from the waypoint.
+  void ApplyWaypoint(Env &env, const MobilityTrace::Waypoint &waypoint);
+
+  // Evaluates the segment of given node, adds it to nodes and old_positions if
+  // the position of the node has changed.
+  void EvaluateNode(Env &env, NodeID node, std::vector<NodeID> &nodes,
+                    std::vector<Position> &old_positions);
+
+  void ScheduleStep(Env &env, Time time);
+
+  // Plan of a node moved by MoveEvents.
+  struct Plan {
+    bool active = false;
+    Position destination;
+    double speed = 0;  // m/s
+    Time pause = 0;
+    std::unique_ptr<PositionGenerator> directions = nullptr;
+  };
+
+  // Gives a new plan to the node.
+  // RETURNS: false if the node ran out of destinations.
+  static bool AssignNewPlan(const Parameters &parameters, Plan &plan);
+
+  // Moves the position along the plan by time_diff.
+  // RETURNS: true if the position has changed.
+  static bool Advance(Plan &plan, Position &position, Time time_diff);
+
+  Network &network_;
+  // Plans of nodes moved by MoveEvents, indexed by NodeID.
+  std::vector<Plan> plans_;
+  // Lazy mode, segments are indexed by NodeID.
+  std::vector<Segment> segments_;
+  std::vector<NodeID> lazy_nodes_;
+  std::map<Time, std::vector<NodeID>> segment_ends_;
+  // Trace mode, opened when the first node is added.
+  std::unique_ptr<MobilityTrace> trace_ = nullptr;
+};
+
+}  // namespace simulation
+
+#endif  // SARP_STRUCTURE_MOBILITY_H_
@@ -0,0 +1,61 @@
+//
+// mobility_trace.h
+//
+
+#ifndef SARP_STRUCTURE_MOBILITY_TRACE_H_
+#define SARP_STRUCTURE_MOBILITY_TRACE_H_
+
+#include <string>
+#include <string_view>
+
+#include "structure/mapped_file.h"
+#include "structure/position.h"
+#include "structure/types.h"
+
+namespace simulation {
+
+// Streams waypoints of nodes from memory mapped ns-2 setdest style file:
+//   $node_(3) set X_ 150.0
+//   $ns_ at 12.5 "$node_(3) setdest 80.0 40.0 2.5"
+// Times are in seconds, coordinates in meters and speeds in m/s. Setdest may
+// also have x, y, z and speed. Lines setting coordinates are applied at time
+// 0, other lines are skipped. Waypoints have to be ordered by time, only the
+// next one is kept in memory.
+class MobilityTrace final {
+ public:
+  struct Waypoint {
+    // Index of the coordinate set by the waypoint or -1 for setdest.
+    int coordinate = -1;
+    Time time = 0;  // ms
+    NodeID node = 0;
+    int value = 0;  // Value of the set coordinate.
+    Position destination;
+    double speed = 0;  // m/s
+  };
+
+  // Throws std::runtime_error if the file can not be opened.
+  MobilityTrace(const std::string &path);
+
+  MobilityTrace(const MobilityTrace &) = delete;
+  MobilityTrace &operator=(const MobilityTrace &) = delete;
+
+  // RETURNS: next waypoint or nullptr at the end of the trace, the waypoint
+  // is valid until the next call of Pop.
+  const Waypoint *Peek() const { return has_next_ ? &next_ : nullptr; }
+
+  // Moves to the next waypoint.
+  void Pop();
+
+ private:
+  // RETURNS: true if the line contains a waypoint, stores it to next_.
+  bool ParseLine(std::string_view line);
+
+  MappedFile file_;
+  std::string_view remaining_;
+  bool has_next_ = false;
+  Waypoint next_;
+};
+
+}  // namespace simulation
+
+#endif  // SARP_STRUCTURE_MOBILITY_TRACE_H_
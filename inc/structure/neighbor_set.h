@@ -0,0 +1,71 @@
+//
+// neighbor_set.h
+//
+
+#ifndef SARP_STRUCTURE_NEIGHBOR_SET_H_
+#define SARP_STRUCTURE_NEIGHBOR_SET_H_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "structure/types.h"
+
+namespace simulation {
+
+// Neighbors of a node sorted by NodeID together with the delivery duration of
+// each link. Small sets are kept inline, bigger ones are moved to the heap.
+class NeighborSet final {
+ public:
+  struct Link {
+    NodeID id;
+    Time delivery_duration;
+  };
+
+  using const_iterator = const Link *;
+
+  // Stores ids present in first and missing in second to result.
+  static void Difference(const NeighborSet &first, const NeighborSet &second,
+                         std::vector<NodeID> *result);
+
+  NeighborSet() = default;
+
+  NeighborSet(const NeighborSet &other) = default;
+
+  NeighborSet(NeighborSet &&other);
+
+  NeighborSet &operator=(const NeighborSet &other) = default;
+
+  NeighborSet &operator=(NeighborSet &&other);
+
+  // Appends a link, ids have to be pushed in increasing order.
+  void PushBack(const Link &link);
+
+  // RETURNS: link to given neighbor or nullptr if it is not present.
+  const Link *Find(NodeID id) const;
+
+  bool contains(NodeID id) const { return Find(id) != nullptr; }
+
+  const_iterator begin() const { return data(); }
+
+  const_iterator end() const { return data() + size_; }
+
+  std::size_t size() const { return size_; }
+
+  bool empty() const { return size_ == 0; }
+
+ private:
+  static constexpr uint32_t INLINE_CAPACITY = 8;
+
+  const Link *data() const {
+    return heap_links_.empty() ? inline_links_.data() : heap_links_.data();
+  }
+
+  uint32_t size_ = 0;
+  std::array<Link, INLINE_CAPACITY> inline_links_;
+  std::vector<Link> heap_links_;  // Used once size_ exceeds INLINE_CAPACITY.
+};
+
+}  // namespace simulation
+
+#endif  // SARP_STRUCTURE_NEIGHBOR_SET_H_
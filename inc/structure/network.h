@@ -5,14 +5,20 @@
 #ifndef SARP_STRUCTURE_NETWORK_H_
 #define SARP_STRUCTURE_NETWORK_H_
 
+#include <array>
+#include <cassert>
+#include <limits>
 #include <map>
 #include <memory>
-#include <set>
 #include <vector>
 
+#include "structure/mobility.h"
 #include "structure/node.h"
 #include "structure/position.h"
+#include "structure/position_cell.h"
 #include "structure/simulation.h"
+#include "structure/thread_pool.h"
+#include "structure/topology.h"
 
 namespace simulation {
 
@@ -21,34 +27,156 @@ struct Env;
 class PositionCube;
 class Parameters;
 
+// Nodes are stored by value in one vector in order of their boot. With
+// Parameters::General::reorder_period the vector is periodically sorted along
+// a Morton curve of node positions so that nodes close in space are close in
+// memory. Other parts of the simulation refer to them by NodeID which is mapped
+// to the position in that vector, so Node pointers and references are only
+// valid until the next node is added or the nodes are reordered. Whatever
+// depends on the order of nodes has to iterate get_boot_order() instead.
+// With a topology set neighbors are read from it, nodes are not placed to
+// cubes and their positions do not affect connectivity.
 class Network final {
   friend class Simulation;
-  using NodeContainer = std::vector<std::unique_ptr<Node>>;
+  using NodeContainer = std::vector<Node>;
 
  public:
-  Node &AddNode(const Parameters &parameters, std::unique_ptr<Node> node);
-
+  Node &AddNode(const Parameters &parameters, Node &&node);
+
+  // Recomputes neighbors of all nodes in two phases. First new neighbors are
+  // found for all nodes, in parallel if Parameters::General::worker_threads
+  // is greater than 1, since it only reads positions. Then they are applied to
+  // nodes and their routing in boot order so the results do not depend on the
+  // number of threads.
+  // With Parameters::General::half_stencil the first phase visits each pair
+  // of cells once and writes both neighbor sets, it runs on one thread.
+  // Nodes are reordered beforehand once reorder_period has passed.
+  // With a topology neighbors are its links to booted nodes.
   void UpdateNeighbors(Env &env);
 
+  // Connects or disconnects two nodes of the topology, neighbors of both of
+  // them are updated immediately if they are booted.
+  void UpdateLink(Env &env, NodeID node1, NodeID node2, bool connected,
+                  Time delivery_duration);
+
+  // RETURNS: true if the nodes are the same node or connected by a link of
+  // the topology or, without one, if they are in connection range.
+  bool AreConnected(const Parameters &parameters, const Node &node1,
+                    const Node &node2) const;
+
+  // Finds two distinct nodes closest to each other, at least two nodes have to
+  // be present. Nodes are compared only with nodes in adjacent cubes, first in
+  // the cubes nodes are placed in and then in bigger ones until the pair found
+  // is closer than the cube side, so the cost is linear for evenly spread
+  // nodes. Cubes are processed in parallel with worker_threads.
+  // RETURNS: ids of the closest nodes.
+  std::pair<NodeID, NodeID> FindClosestPair(const Parameters &parameters);
+
+  // RETURNS: thread pool with given thread count, (re)creates it if needed.
+  ThreadPool &GetThreadPool(unsigned thread_count);
+
   // Exports the network to .dot format to given output stream.
   void ExportToDot(std::ostream &os) const;
 
-  void UpdateNodePosition(const Parameters &parameters, const Node &node,
-                          const Position &old_position);
+  // Moves nodes which have changed their positions between cells.
+  void UpdateNodePositions(const Parameters &parameters,
+                           const std::vector<NodeID> &nodes,
+                           const std::vector<Position> &old_positions);
+
+  // RETURNS: node with given id or nullptr if it has not booted yet.
+  Node *get_node(NodeID id) {
+    return (id < slots_.size() && slots_[id] != NO_SLOT) ? &nodes_[slots_[id]]
+                                                         : nullptr;
+  }
 
-  Node *get_node(NodeID id);
+  const Node *get_node(NodeID id) const {
+    return const_cast<Network *>(this)->get_node(id);
+  }
 
+  // Nodes in storage order, use only where the order does not matter.
   const NodeContainer &get_nodes() const { return nodes_; }
 
   NodeContainer &get_nodes() { return nodes_; }
 
+  Mobility &get_mobility() { return mobility_; }
+
+  // RETURNS: ids of booted nodes in order of their boot.
+  const std::vector<NodeID> &get_boot_order() const { return boot_order_; }
+
+  // Switches the network to topology mode, has to be set before any node
+  // boots.
+  void set_topology(std::unique_ptr<Topology> topology) {
+    assert(nodes_.empty());
+    topology_ = std::move(topology);
+  }
+
+  // RETURNS: topology of the network or nullptr if it is given by positions.
+  const Topology *get_topology() const { return topology_.get(); }
+
  private:
   using CubeID = std::size_t;
 
+  static constexpr uint32_t NO_SLOT = std::numeric_limits<uint32_t>::max();
+
+  using CellOffset = std::array<int, 3>;
+
+  // RETURNS: side of cubes used to place nodes.
+  static uint32_t GetCellSide(const Parameters &parameters);
+
   void PlaceNode(const Parameters &parameters, Node &node);
 
+  struct ClosestPair {
+    int64_t distance_squared = std::numeric_limits<int64_t>::max();
+    NodeID node1 = 0;
+    NodeID node2 = 0;
+  };
+
+  // Finds closest pair of nodes in the cubes nodes are placed in and their
+  // neighboring cubes.
+  ClosestPair FindClosestPlacedPair(const Parameters &parameters);
+
+  // Finds closest pair of nodes in neighboring cubes of given side.
+  ClosestPair FindClosestPairInGrid(const Parameters &parameters,
+                                    int64_t cell_side);
+
+  // Sorts nodes_ by Morton code of their cubes, ties are broken by NodeID.
+  void ReorderNodes(const Parameters &parameters);
+
+  // Recomputes the stencil if the cell side has changed.
+  void UpdateStencil(const Parameters &parameters);
+
+  NeighborSet FindNeighbors(const Parameters &parameters,
+                            const Node &node) const;
+
+  // Finds neighbors of all nodes using the forward half of the stencil. Ids
+  // are appended in arbitrary order and may repeat.
+  void FindNeighborPairs(
+      const Parameters &parameters,
+      std::vector<std::vector<NodeID>> &neighbor_ids) const;
+
+  // RETURNS: links of the topology from the booted node to booted nodes and
+  // the node itself.
+  NeighborSet FindTopologyNeighbors(NodeID node) const;
+
+  // Creates neighbor set of the node from unordered ids, sorts neighbor_ids.
+  NeighborSet CreateNeighborSet(const Node &node,
+                                std::vector<NodeID> &neighbor_ids) const;
+
   NodeContainer nodes_;
-  std::map<CubeID, std::set<Node *>> node_placement_;
+  std::vector<uint32_t> slots_;  // Index to nodes_ for each NodeID.
+  std::vector<NodeID> boot_order_;
+  Time next_reorder_time_ = 0;
+  std::map<CubeID, PositionCell> node_placement_;
+  // Offsets of all cubes which may contain a node in range of some point of
+  // the center cube in lexicographic order. Offsets following {0, 0, 0} form
+  // the forward half, the remaining ones are their mirror images.
+  std::vector<CellOffset> stencil_;
+  std::size_t stencil_center_ = 0;
+  uint32_t stencil_cell_side_ = 0;
+  uint32_t stencil_range_ = 0;
+  std::unique_ptr<ThreadPool> thread_pool_ = nullptr;
+  std::unique_ptr<Topology> topology_ = nullptr;
+  Mobility mobility_{*this};
 };
 
 }  // namespace simulation
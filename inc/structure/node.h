@@ -7,11 +7,13 @@
 
 #include <cassert>
 #include <functional>
+#include <map>
 #include <memory>
 #include <set>
 #include <unordered_set>
 #include <vector>
 
+#include "structure/neighbor_set.h"
 #include "structure/packet.h"
 #include "structure/position.h"
 #include "structure/routing.h"
@@ -30,11 +32,8 @@ class Node final {
  public:
   static void ResetID() { next_id_ = 0; }
 
-  struct MobilityPlan {
-    Position destination;
-    double speed;
-    Time pause;
-  };
+  // RETURNS: time it takes to deliver a packet between given nodes.
+  static Time DeliveryDuration(const Node &n1, const Node &n2);
 
   using AddressContainerType = std::set<Address>;
 
@@ -42,6 +41,8 @@ class Node final {
 
   Node(Node &&node) { *this = std::move(node); }  // use operator==(Node &&)
 
+  // Moves the node together with its routing which is pointed to the new
+  // location of the node.
   Node &operator=(Node &&);
 
   // WARNING: No copy constructor and copy assignment operator  due to nature of
@@ -51,13 +52,15 @@ class Node final {
 
   void Send(Env &env, std::unique_ptr<Packet> packet);
 
-  void Recv(Env &env, std::unique_ptr<Packet> packet, Node *form_node);
+  void Recv(Env &env, std::unique_ptr<Packet> packet, NodeID from_node);
 
   bool IsInitialized() const { return routing_ != nullptr; }
 
   bool IsConnectedTo(const Node &node, uint32_t connection_range) const;
 
-  void UpdateNeighbors(Env &env, std::set<Node *> new_neighbors);
+  // Replaces neighbors of the node and notifies routing about the neighbors
+  // which were added or removed.
+  void UpdateNeighbors(Env &env, NeighborSet new_neighbors);
 
   NodeID get_id() const { return id_; }
 
@@ -65,18 +68,23 @@ class Node final {
 
   void AddAddress(Address addr);
 
-  void InitializeAddresses(Node::AddressContainerType addresses);
+  // Makes the address the latest one and adds it if the node does not have it
+  // yet. Unlike addresses added by AddAddress it expires once it is not
+  // refreshed for a while, see ExpireAddresses.
+  void RefreshAddress(Address addr, Time time);
 
-  void Move(Time time_diff);
+  // Removes refreshed addresses whose last refresh was at or before given
+  // time, the latest address is always kept. Routing withdraws them.
+  // RETURNS: number of removed addresses.
+  std::size_t ExpireAddresses(Env &env, Time time);
 
-  bool has_mobility_plan() const { return mobility_.first; }
+  void InitializeAddresses(Node::AddressContainerType addresses);
 
-  void set_mobility_plan(const MobilityPlan &new_plan) {
-    mobility_ = {true, new_plan};
+  void set_position(Position position) {
+    position_ = position;
+    moved_ = true;
   }
 
-  void set_position(Position position) { position_ = position; }
-
   const Address get_address() const {
     return (addresses_.size() == 0) ? Address() : *latest_address_;
   }
@@ -86,7 +94,7 @@ class Node final {
     return addresses_;
   }
 
-  const std::set<Node *> &get_neighbors() const { return neighbors_; }
+  const NeighborSet &get_neighbors() const { return neighbors_; }
 
   void set_routing(std::unique_ptr<Routing> routing) {
     routing_ = std::move(routing);
@@ -109,9 +117,13 @@ class Node final {
   Position position_;
   AddressContainerType::iterator latest_address_;
   AddressContainerType addresses_;
-  std::set<Node *> neighbors_;
+  // Time of the last refresh of addresses added by RefreshAddress.
+  std::map<Address, Time> refresh_times_;
+  NeighborSet neighbors_;
+  // Node has moved since its neighbors were updated, i.e. delivery durations
+  // of its links are outdated.
+  bool moved_ = false;
   std::unique_ptr<Routing> routing_ = nullptr;
-  std::pair<bool, MobilityPlan> mobility_;
 };
 
 }  // namespace simulation
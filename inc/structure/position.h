@@ -5,6 +5,7 @@
 #ifndef SARP_STRUCTURE_POSITION_H_
 #define SARP_STRUCTURE_POSITION_H_
 
+#include <cstdint>
 #include <iostream>
 
 namespace simulation {
@@ -17,11 +18,31 @@ struct Position final {
 
   static double Distance(const Position &pos1, const Position &pos2);
 
+  // Squared distance computed in integer arithmetic i.e. without the sqrt.
+  static int64_t DistanceSquared(const Position &pos1, const Position &pos2);
+
+  // Exclusive limit on DistanceSquared of two positions in given range.
+  // Range check compares truncated distance i.e. uint32_t(Distance) <= range
+  // which is equivalent to DistanceSquared < (range + 1)^2.
+  static int64_t RangeSquaredLimit(uint32_t range) {
+    const int64_t limit = static_cast<int64_t>(range) + 1;
+    return limit * limit;
+  }
+
+  static bool IsInRange(const Position &pos1, const Position &pos2,
+                        uint32_t range) {
+    return DistanceSquared(pos1, pos2) < RangeSquaredLimit(range);
+  }
+
   bool operator==(const Position &other) const;
 
   int x, y, z;
 };
 
+// RETURNS: Morton code of given cube coordinates i.e. their interleaved bits
+// with x in the lowest bit, lower 21 bits of each coordinate are used.
+uint64_t MortonCode(uint64_t x, uint64_t y, uint64_t z);
+
 struct PositionCube final {
   friend std::ostream &operator<<(std::ostream &os,
                                   const PositionCube &position_cube);
@@ -29,15 +50,19 @@ struct PositionCube final {
  public:
   PositionCube() = default;
   PositionCube(uint32_t x, uint32_t y, uint32_t z);
-  PositionCube(const Position &p, uint32_t connection_range);
+  PositionCube(const Position &p, uint32_t cell_side);
 
   static int Distance(const PositionCube &pos1, const PositionCube &pos2);
 
   std::size_t GetID(Position min_pos, Position max_pos,
-                    uint32_t connection_range) const;
-
-  std::pair<PositionCube, bool> GetRelativeCube(
-      const int relative_pos[3]) const;
+                    uint32_t cell_side) const;
+
+  // RETURNS: cube at given offset and true, false if the offset leads out of
+  // the grid of cubes covering the boundaries.
+  std::pair<PositionCube, bool> GetRelativeCube(const int relative_pos[3],
+                                                Position min_pos,
+                                                Position max_pos,
+                                                uint32_t cell_side) const;
 
   bool operator==(const PositionCube &other) const;
 
@@ -0,0 +1,91 @@
+//
+// position_cell.h
+//
+
+#ifndef SARP_STRUCTURE_POSITION_CELL_H_
+#define SARP_STRUCTURE_POSITION_CELL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "structure/position.h"
+#include "structure/types.h"
+
+namespace simulation {
+
+// Tests given position against count candidates stored as structure of arrays
+// xs, ys, zs. Index of each candidate with Position::DistanceSquared <
+// squared_limit is written to matches which has to have room for count items.
+// Uses AVX2 or SSE4.1 when compiled with support for it, plain loop otherwise.
+// RETURNS: number of indices written to matches.
+std::size_t FilterInRange(const Position &position, int64_t squared_limit,
+                          const int *xs, const int *ys, const int *zs,
+                          std::size_t count, uint32_t *matches);
+
+// Nodes placed in one cube of the network space with their coordinates kept
+// as structure of arrays so that the whole cube is tested at once.
+class PositionCell final {
+ public:
+  void Insert(NodeID node, const Position &position);
+
+  void Erase(NodeID node);
+
+  // Updates stored coordinates of a node after it has moved within the cell.
+  void Update(NodeID node, const Position &position);
+
+  // Appends all nodes of this cell in range of given position to result.
+  void CollectInRange(const Position &position, int64_t squared_limit,
+                      std::vector<NodeID> *result) const;
+
+  // Calls f(node, other_node) for each pair of a node of this cell and a node
+  // of other cell which are in range. If other is this cell every unordered
+  // pair is visited once, including each node paired with itself.
+  template <typename F>
+  void ForEachPairInRange(const PositionCell &other, int64_t squared_limit,
+                          F &&f) const;
+
+  NodeID get_node(std::size_t i) const { return nodes_[i]; }
+
+  Position get_position(std::size_t i) const {
+    return Position(x_[i], y_[i], z_[i]);
+  }
+
+  bool empty() const { return nodes_.empty(); }
+
+  std::size_t size() const { return nodes_.size(); }
+
+ private:
+  std::size_t IndexOf(NodeID node) const;
+
+  std::vector<NodeID> nodes_;
+  std::vector<int> x_;
+  std::vector<int> y_;
+  std::vector<int> z_;
+};
+
+template <typename F>
+void PositionCell::ForEachPairInRange(const PositionCell &other,
+                                      int64_t squared_limit, F &&f) const {
+  constexpr std::size_t chunk = 64;
+  uint32_t matches[chunk];
+  for (std::size_t i = 0; i < nodes_.size(); ++i) {
+    // Within one cell pair only with nodes from i onward.
+    std::size_t first = (&other == this) ? i : 0;
+    for (std::size_t begin = first; begin < other.nodes_.size();
+         begin += chunk) {
+      std::size_t count = std::min(chunk, other.nodes_.size() - begin);
+      std::size_t found = FilterInRange(
+          get_position(i), squared_limit, other.x_.data() + begin,
+          other.y_.data() + begin, other.z_.data() + begin, count, matches);
+      for (std::size_t j = 0; j < found; ++j) {
+        f(nodes_[i], other.nodes_[begin + matches[j]]);
+      }
+    }
+  }
+}
+
+}  // namespace simulation
+
+#endif  // SARP_STRUCTURE_POSITION_CELL_H_
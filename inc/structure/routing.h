@@ -18,6 +18,7 @@ class Statistics;
 
 class Routing {
   friend std::ostream &operator<<(std::ostream &os, const Routing &r);
+  friend class Node;  // To keep node_ valid when the node is moved.
 
  public:
   static unsigned GetUpdateConvergence() { return period_; }
@@ -29,10 +30,11 @@ class Routing {
   // a given node.
   virtual void Init(Env &env) = 0;
 
-  // Update neighbors after the movement of nodes.
-  // Uses node_.get_neighbors().
-  virtual void UpdateNeighbors(Env &env,
-                               const std::set<Node *> &current_neighbors) = 0;
+  // Update neighbors after the movement of nodes. Called only if some
+  // neighbors were added or removed, node_.get_neighbors() already holds the
+  // new neighbors. Both lists are sorted.
+  virtual void UpdateNeighbors(Env &env, const std::vector<NodeID> &added,
+                               const std::vector<NodeID> &removed) = 0;
 
   // Finds route for the given packet.
   // RETURNS: nullptr iff packet shouldn't be routed otherwise a Node to
@@ -40,15 +42,20 @@ class Routing {
   virtual Node *Route(Env &env, Packet &packet) = 0;
 
   // Processes given packet which came from from_node.
-  virtual void Process(Env &env, Packet &packet, Node *from_node) = 0;
+  virtual void Process(Env &env, Packet &packet, NodeID from_node) = 0;
 
   // Send update to one selected neighbor
-  virtual void SendUpdate(Env &env, Node *neighbor) = 0;
+  virtual void SendUpdate(Env &env, NodeID neighbor) = 0;
 
   virtual std::size_t GetRecordsCount() const = 0;
 
   virtual void UpdateAddresses() = 0;
 
+  // Called after given addresses were removed from the node so that the
+  // routing stops advertising them.
+  virtual void WithdrawAddresses(Env &env,
+                                 const std::vector<Address> &addresses) = 0;
+
   virtual std::pair<Address, bool> SelectAddress(Env &) const {
     return {Address(), false};
   }
@@ -66,11 +73,12 @@ class Routing {
   // Called by CheckPeriodicUpdate in RoutingUpdateEvent.
   void RequestAllUpdates(Env &env);
 
-  void NotifyChange();
+  void NotifyChange(Env &env);
 
-  void RequestUpdate(Env &env, Node *neighbor);
+  // Schedules SendUpdate of the neighbor to this.
+  virtual void RequestUpdate(Env &env, NodeID neighbor);
 
-  Node &node_;
+  Node *node_;
   bool change_occured_ = false;
 
  private:
@@ -10,12 +10,16 @@
 #include <iostream>
 #include <memory>
 #include <queue>
+#include <string>
+#include <vector>
 
 #include "network_generator/address_generator.h"
 #include "network_generator/event_generator.h"
 #include "network_generator/position_generator.h"
 #include "sarp/cost.h"
+#include "structure/address_pool.h"
 #include "structure/event.h"
+#include "structure/flow.h"
 #include "structure/network.h"
 #include "structure/node.h"
 #include "structure/types.h"
@@ -42,6 +46,14 @@ struct Parameters final {
     Time neighbor_update_period = 0;
     Time routing_update_period = 0;
     range<Position> boundaries = {Position(0, 0, 0), Position(0, 0, 0)};
+    // Threads used for parallel phases, they do not affect the results.
+    unsigned worker_threads = 1;
+    // Neighbor search uses cubes of side connection_range / cell_divisor.
+    uint32_t cell_divisor = 1;
+    // Neighbor search tests each pair of nodes once and updates both of them.
+    bool half_stencil = false;
+    // Period of sorting node storage along a Morton curve, 0 disables it.
+    Time reorder_period = 0;
   };
 
   struct NodeGeneration {
@@ -66,6 +78,8 @@ struct Parameters final {
 
     range<Time> time_range = {0, 0};
     std::size_t event_count = 0;
+    // Flows are independent of the random traffic above.
+    std::vector<Flow> flows;
   };
 
   struct Movement {
@@ -77,22 +91,44 @@ struct Parameters final {
     range<double> speed_range = {0, 0};  // m/s
     range<Time> pause_range = {0, 0};
     std::unique_ptr<PositionGenerator> directions = nullptr;
+    // Positions are computed from plans on demand instead of in steps.
+    bool lazy_positions = false;
+    // File with waypoints replayed instead of the ones from directions, see
+    // MobilityTrace. Nodes move lazily.
+    std::string trace;
   };
 
   struct Sarp {
     static void PrintCsvHeader(std::ostream &os);
     void PrintCsv(std::ostream &os) const;
+    // Columns of the digest exchange, see Parameters::PrintSarpCsv.
+    static void PrintDigestCsvHeader(std::ostream &os);
+    void PrintDigestCsv(std::ostream &os) const;
 
     Cost neighbor_cost{1, 0.1};
     double compact_treshold = 3;
     double update_treshold = 0.9;
     double ratio_variance_treshold = 0.2;
     double min_standard_deviation = 0.1;
+    // Requests are packets with the digest of the update held from the
+    // neighbor, which replies with the changes since if it has kept that
+    // update, see SarpDigestRequestPacket.
+    bool digest_exchange = false;
+    // Number of previous updates kept by each node for the digest exchange.
+    std::size_t digest_history = 4;
+    // Costs which differ from the last ones sent by less than this in both
+    // mean and variance are sent as before in the digest exchange.
+    double digest_cost_quantum = 0;
   };
 
   static void PrintCsvHeader(std::ostream &os);
   void PrintCsv(std::ostream &os) const;
 
+  // Columns of SARP parameters printed after the other parameters only when
+  // SARP runs, so that rows of the other routings are unchanged.
+  static void PrintSarpCsvHeader(std::ostream &os);
+  void PrintSarpCsv(std::ostream &os) const;
+
   void AddGeneral(General parameters) { general_ = {true, parameters}; }
   bool has_general() const { return general_.first; }
   const General &get_general() const {
@@ -230,7 +266,7 @@ class Statistics final {
 
   void RegisterRecvEvent() { ++recv_event_; }
 
-  void RegisterMoveEvent() { ++move_event_; }
+  void RegisterMoveEvents(std::size_t count) { move_event_ += count; }
 
   void RegisterUpdateNeighborsEvent() { ++update_neighbors_event_; }
 
@@ -278,6 +314,8 @@ struct Env {
   Simulation simulation;
   Statistics stats;
   Parameters parameters;
+  Network *network = nullptr;  // Resolves NodeIDs held by events and routing.
+  AddressPool address_pool;  // Resolves AddressIDs held by routing.
 };
 
 }  // namespace simulation
@@ -0,0 +1,61 @@
+//
+// thread_pool.h
+//
+
+#ifndef SARP_STRUCTURE_THREAD_POOL_H_
+#define SARP_STRUCTURE_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace simulation {
+
+// Fixed set of worker threads used for data parallel phases of the
+// simulation. Threads are kept alive between calls of ParallelFor.
+class ThreadPool final {
+ public:
+  using Task = std::function<void(std::size_t begin, std::size_t end)>;
+
+  // Creates pool with given number of threads including the calling thread,
+  // i.e. thread_count - 1 workers are spawned.
+  ThreadPool(unsigned thread_count);
+
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  // Splits [0, count) to chunks and runs task on them on all threads.
+  // Returns after all chunks are processed.
+  void ParallelFor(std::size_t count, const Task &task);
+
+  unsigned get_thread_count() const { return workers_.size() + 1; }
+
+ private:
+  void WorkerLoop();
+
+  // Processes chunks of the current job until there are none left.
+  void RunChunks();
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable job_ready_;
+  std::condition_variable job_done_;
+  bool stop_ = false;
+  std::size_t job_id_ = 0;
+  unsigned busy_workers_ = 0;
+
+  const Task *task_ = nullptr;
+  std::size_t count_ = 0;
+  std::size_t chunk_ = 0;
+  std::atomic<std::size_t> next_ = 0;
+};
+
+}  // namespace simulation
+
+#endif  // SARP_STRUCTURE_THREAD_POOL_H_
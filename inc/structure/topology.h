@@ -0,0 +1,72 @@
+//
+// topology.h
+//
+
+#ifndef SARP_STRUCTURE_TOPOLOGY_H_
+#define SARP_STRUCTURE_TOPOLOGY_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "structure/neighbor_set.h"
+#include "structure/types.h"
+
+namespace simulation {
+
+// Explicit undirected graph of links between nodes identified by NodeID. When
+// a network has a topology it is used instead of positions and
+// connection_range to find neighbors of nodes.
+class Topology final {
+ public:
+  using Link = NeighborSet::Link;
+
+  // Used for links without delivery duration in the edge list.
+  static constexpr Time DEFAULT_DELIVERY_DURATION = 1;
+
+  // Topology of node_count nodes without links.
+  explicit Topology(std::size_t node_count = 0) : links_(node_count) {}
+
+  // Loads links between node_count nodes from memory mapped text file with
+  // lines in format: node1 node2 [delivery_duration], lines which do not start
+  // with a number are skipped. Links listed more than once keep their first
+  // delivery duration. Throws std::runtime_error naming the line if a node id
+  // is missing or not less than node_count, or if the file can not be opened.
+  static std::unique_ptr<Topology> FromEdgeList(const std::string &path,
+                                                std::size_t node_count);
+
+  // Loads links from binary file written by WriteBinaryCsr. Throws
+  // std::runtime_error if the file can not be opened, the topology is empty
+  // if its content is not valid.
+  static std::unique_ptr<Topology> FromBinaryCsr(const std::string &path);
+
+  // Writes links in compressed sparse row format: 8 byte magic "SARPCSR1",
+  // 8 byte node count n, 8 byte count m of directed links, n + 1 offsets of
+  // links of each node as 8 byte integers, m neighbor ids and m delivery
+  // durations as 4 byte integers, all in native byte order. Each link is
+  // stored once for each direction.
+  // RETURNS: false on failure.
+  bool WriteBinaryCsr(const std::string &path) const;
+
+  // Adds link between given nodes or updates its delivery duration. Throws
+  // std::out_of_range if a node is not in the topology.
+  void AddLink(NodeID node1, NodeID node2, Time delivery_duration);
+
+  void RemoveLink(NodeID node1, NodeID node2);
+
+  // RETURNS: link from node to neighbor or nullptr if they are not linked.
+  const Link *FindLink(NodeID node, NodeID neighbor) const;
+
+  // RETURNS: links of given node sorted by neighbor id.
+  const std::vector<Link> &get_links(NodeID node) const;
+
+  std::size_t get_node_count() const { return links_.size(); }
+
+ private:
+  // Links of each node sorted by neighbor id.
+  std::vector<std::vector<Link>> links_;
+};
+
+}  // namespace simulation
+
+#endif  // SARP_STRUCTURE_TOPOLOGY_H_
@@ -7,19 +7,19 @@
 
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <ostream>
 #include <utility>
 #include <vector>
 
+#include "structure/address.h"
+
 namespace simulation {
 
 using Time = std::size_t;
 
-using NodeID = std::size_t;
-
-using AddressComponent = unsigned char;
-
-using Address = std::vector<AddressComponent>;
+// Nodes are numbered densely from 0 in order of their creation.
+using NodeID = uint32_t;
 
 template <typename T>
 using range = std::pair<T, T>;
@@ -33,8 +33,6 @@ enum class RoutingType { DISTANCE_VECTOR, SARP };
 
 enum class PacketType { ROUTING, DATA };
 
-std::ostream &operator<<(std::ostream &os, const Address &addr);
-
 std::ostream &operator<<(std::ostream &os, const RoutingType &r);
 
 template <typename T>
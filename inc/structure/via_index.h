@@ -0,0 +1,65 @@
+//
+// via_index.h
+//
+
+#ifndef SARP_STRUCTURE_VIA_INDEX_H_
+#define SARP_STRUCTURE_VIA_INDEX_H_
+
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "structure/types.h"
+
+namespace simulation {
+
+// Secondary index of a routing table stored in a node based container, groups
+// iterators to its records by the neighbor the records are routed through.
+// Iterators have to stay valid until they are erased from the index.
+template <typename Iterator>
+class ViaIndex final {
+ public:
+  void Insert(NodeID via_node, Iterator record) {
+    records_[via_node].insert(record);
+  }
+
+  void Erase(NodeID via_node, Iterator record) {
+    auto via_it = records_.find(via_node);
+    if (via_it == records_.end()) {
+      return;
+    }
+    via_it->second.erase(record);
+    if (via_it->second.empty()) {
+      records_.erase(via_it);
+    }
+  }
+
+  // Removes all records routed through via_node from the index.
+  // RETURNS: the removed records.
+  std::vector<Iterator> Extract(NodeID via_node) {
+    auto via_it = records_.find(via_node);
+    if (via_it == records_.end()) {
+      return {};
+    }
+    std::vector<Iterator> result(via_it->second.cbegin(),
+                                 via_it->second.cend());
+    records_.erase(via_it);
+    return result;
+  }
+
+  void Clear() { records_.clear(); }
+
+ private:
+  // Records are unique by their address in memory.
+  struct IteratorLess {
+    bool operator()(const Iterator &lhs, const Iterator &rhs) const {
+      return &*lhs < &*rhs;
+    }
+  };
+
+  std::unordered_map<NodeID, std::set<Iterator, IteratorLess>> records_;
+};
+
+}  // namespace simulation
+
+#endif  // SARP_STRUCTURE_VIA_INDEX_H_
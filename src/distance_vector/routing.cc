@@ -14,26 +14,29 @@ namespace simulation {
 
 DistanceVectorRouting::DistanceVectorRouting(Node &node) : Routing(node) {}
 
-Node *DistanceVectorRouting::Route(Env &, Packet &packet) {
+Node *DistanceVectorRouting::Route(Env &env, Packet &packet) {
   // Find a matching record.
-  const auto it = table_.find(packet.get_destination_address());
-  if (it != table_.end()) {
-    assert(it->second.via_node != &node_);
-    return it->second.via_node;
+  const auto match =
+      GetForwardingTable().Lookup(packet.get_destination_address());
+  if (match.via_node != ForwardingTable::NO_HOP) {
+    assert(match.via_node != node_->get_id());
+    return env.network->get_node(match.via_node);
   } else {
     return nullptr;
   }
 }
 
-void DistanceVectorRouting::Process(Env &env, Packet &packet, Node *from_node) {
+void DistanceVectorRouting::Process(Env &env, Packet &packet,
+                                    NodeID from_node) {
   assert(packet.IsRoutingUpdate());
   env.stats.RegisterRoutingOverheadDelivered();
 
   auto &update_packet = dynamic_cast<DVRoutingUpdate &>(packet);
   change_occured_ = UpdateRouting(update_packet.RetrieveUpdate(), from_node);
   if (change_occured_) {
+    fib_outdated_ = true;
     CreateUpdateMirror();
-    NotifyChange();
+    NotifyChange(env);
   }
 }
 
@@ -42,61 +45,74 @@ void DistanceVectorRouting::Init(Env &env) {
   CheckPeriodicUpdate(env);
 }
 
-void DistanceVectorRouting::SendUpdate(Env &env, Node *neighbor) {
+void DistanceVectorRouting::SendUpdate(Env &env, NodeID neighbor) {
   // Create update packet.
   std::unique_ptr<Packet> packet = std::make_unique<DVRoutingUpdate>(
-      node_.get_address(), neighbor->get_address(), update_mirror_);
+      node_->get_address(), env.network->get_node(neighbor)->get_address(),
+      update_mirror_);
   // Register to statistics before we move packet away.
   env.stats.RegisterRoutingOverheadSend();
   env.stats.RegisterRoutingOverheadSize(packet->get_size());
   // Schedule immediate recieve on neighbor to bypass Node::Send() which calls
   // Routing::Route which is not desired.
   env.simulation.ScheduleEvent(std::make_unique<RecvEvent>(
-      1, TimeType::RELATIVE, node_, *neighbor, std::move(packet)));
+      1, TimeType::RELATIVE, node_->get_id(), neighbor, std::move(packet)));
 }
 
 void DistanceVectorRouting::UpdateAddresses() {
-  for (const auto &address : node_.get_addresses()) {
-    auto [record, success] =
-        table_.insert({address, {.cost = MIN_COST, .via_node = &node_}});
-    if (success == false) {
+  for (const auto &address : node_->get_addresses()) {
+    auto [record, success] = table_.insert(
+        {address, {.cost = MIN_COST, .via_node = node_->get_id()}});
+    if (success) {
+      via_index_.Insert(node_->get_id(), record);
+    } else {
       record->second.cost = MIN_COST;
     }
   }
   change_occured_ = true;
+  fib_outdated_ = true;
+  CreateUpdateMirror();
+}
+
+void DistanceVectorRouting::WithdrawAddresses(
+    Env &, const std::vector<Address> &addresses) {
+  for (const auto &address : addresses) {
+    auto record = table_.find(address);
+    if (record != table_.end() && record->second.via_node == node_->get_id()) {
+      via_index_.Erase(node_->get_id(), record);
+      table_.erase(record);
+    }
+  }
+  change_occured_ = true;
+  fib_outdated_ = true;
   CreateUpdateMirror();
 }
 
 void DistanceVectorRouting::UpdateNeighbors(
-    Env &env, const std::set<Node *> &current_neighbors) {
-  // Search routing table for invalid records.
-  for (auto it = table_.cbegin(); it != table_.end(); /* no increment */) {
-    Node *neighbor = it->second.via_node;
-    if (node_.IsConnectedTo(*neighbor,
-                            env.parameters.get_general().connection_range)) {
-      assert(current_neighbors.contains(neighbor));
-      ++it;
-    } else {
-      assert(current_neighbors.contains(neighbor) == false);
-      it = table_.erase(it);
+    Env &, const std::vector<NodeID> &added,
+    const std::vector<NodeID> &removed) {
+  // Remove records through removed neighbors.
+  for (NodeID neighbor : removed) {
+    for (auto record : via_index_.Extract(neighbor)) {
+      table_.erase(record);
     }
   }
+  if (!removed.empty()) {
+    fib_outdated_ = true;
+  }
   // If there are new neighbors set change_occured for nech CheckPeriodicUpdate.
-  const auto &old_neighbors = node_.get_neighbors();
-  for (const auto current_neighbor : current_neighbors) {
-    if (old_neighbors.contains(current_neighbor) == false) {
-      change_occured_ = true;
-      break;
-    }
+  if (!added.empty()) {
+    change_occured_ = true;
   }
 }
 
 bool DistanceVectorRouting::AddRecord(UpdateTable::const_iterator update_it,
-                                      Node *via_neighbor) {
+                                      NodeID via_neighbor) {
   const auto &[address, cost] = *update_it;
   Cost actual_cost = cost + NEIGHBOR_COST;
   auto [it, success] = table_.insert({address, {actual_cost, via_neighbor}});
   if (success) {
+    via_index_.Insert(via_neighbor, it);
     return true;
   }
   // There is already an element with given address.
@@ -111,7 +127,9 @@ bool DistanceVectorRouting::AddRecord(UpdateTable::const_iterator update_it,
   } else {
     // If it goes through different neighbor pick a better route one.
     if (it->second.cost > actual_cost) {
+      via_index_.Erase(it->second.via_node, it);
       it->second = {.cost = actual_cost, .via_node = via_neighbor};
+      via_index_.Insert(via_neighbor, it);
       return true;
     }
   }
@@ -119,7 +137,7 @@ bool DistanceVectorRouting::AddRecord(UpdateTable::const_iterator update_it,
 }
 
 bool DistanceVectorRouting::UpdateRouting(const UpdateTable &update,
-                                          Node *from_node) {
+                                          NodeID from_node) {
   bool changed = false;
   for (auto it = update.cbegin(); it != update.cend(); ++it) {
     if (AddRecord(it, from_node)) {
@@ -129,6 +147,21 @@ bool DistanceVectorRouting::UpdateRouting(const UpdateTable &update,
   return changed;
 }
 
+const ForwardingTable &DistanceVectorRouting::GetForwardingTable() {
+  if (fib_outdated_) {
+    // Routes lead to exact addresses only.
+    std::vector<ForwardingTable::Entry> entries;
+    entries.reserve(table_.size());
+    for (const auto &[address, cost_neighbor_pair] : table_) {
+      entries.push_back(
+          {address, cost_neighbor_pair.via_node, ForwardingTable::NO_HOP});
+    }
+    fib_ = ForwardingTable(entries);
+    fib_outdated_ = false;
+  }
+  return fib_;
+}
+
 void DistanceVectorRouting::CreateUpdateMirror() {
   update_mirror_.clear();
   for (const auto &[address, cost_neighbor_pair] : table_) {
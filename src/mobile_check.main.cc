@@ -0,0 +1,36 @@
+//
+// mobile_check.cc
+//
+
+#include <iostream>
+
+#include "scenarios/basic.h"
+#include "structure/network.h"
+#include "structure/simulation.h"
+
+using namespace simulation;
+
+// Runs RandomMobileCube with a fixed seed so that its output can be compared
+// between revisions, see the check target of the Makefile. Movement of nodes
+// is random so this catches changes of trajectories which the static
+// scenarios do not.
+int main() {
+  const unsigned seed = 7;
+  for (RoutingType routing :
+       {RoutingType::SARP, RoutingType::DISTANCE_VECTOR}) {
+    Parameters::Sarp sarp_parameters = {.neighbor_cost = Cost(1, 0.1),
+                                        .compact_treshold = 3,
+                                        .update_treshold = 0.05};
+    auto [sp, network, event_generators] =
+        RandomMobileCube(routing, sarp_parameters);
+#ifdef CSV
+    Parameters::PrintCsvHeader(std::cout);
+    if (routing == RoutingType::SARP) {
+      Parameters::PrintSarpCsvHeader(std::cout);
+    }
+    Statistics::PrintCsvHeader(std::cout);
+#endif
+    Simulation::Run(seed, std::move(sp), *network, event_generators);
+  }
+  return 0;
+}
@@ -5,6 +5,7 @@
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
+#include <sstream>
 
 #include "distance_vector/routing.h"
 #include "sarp/routing.h"
@@ -55,6 +56,20 @@ std::unique_ptr<Event> SpecificTrafficGenerator::Next() {
                                         to_.first + idx_to);
 }
 
+FlowGenerator::FlowGenerator(std::vector<Flow> flows, Network &network)
+    : flows_(std::move(flows)), network_(network) {}
+
+std::unique_ptr<Event> FlowGenerator::Next() {
+  while (!flows_.empty()) {
+    Flow flow = std::move(flows_.back());
+    flows_.pop_back();
+    if (flow.time_range.first < flow.time_range.second) {
+      return std::make_unique<FlowEvent>(network_, std::move(flow));
+    }
+  }
+  return nullptr;
+}
+
 NeighborUpdateGenerator::NeighborUpdateGenerator(range<Time> time, Time period,
                                                  Network &network)
     : time_(time),
@@ -149,6 +164,23 @@ std::unique_ptr<Event> NodeGenerator::Next() {
                          address, std::move(directions));
 }
 
+LinkEventGenerator::LinkEventGenerator(const std::string &path,
+                                       Network &network)
+    : network_(network) {
+  const Topology *topology = network_.get_topology();
+  trace_ = std::make_unique<LinkTrace>(
+      path, topology ? topology->get_node_count() : 0);
+}
+
+std::unique_ptr<Event> LinkEventGenerator::Next() {
+  if (trace_ == nullptr || trace_->Peek() == nullptr) {
+    return nullptr;
+  }
+  const Time time = trace_->Peek()->time;
+  return std::make_unique<LinkEvent>(time, TimeType::ABSOLUTE, network_,
+                                     std::move(trace_));
+}
+
 ReaddressEventGenerator::ReaddressEventGenerator(range<Time> time, Time period,
                                                  Network &network)
     : time_(time),
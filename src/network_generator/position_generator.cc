@@ -4,34 +4,176 @@
 
 #include "network_generator/position_generator.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdlib>
-#include <regex>
+#include <cstring>
+#include <iterator>
 #include <string>
 
+#include "structure/hash.h"
+#include "structure/mapped_file.h"
+
 namespace simulation {
 
-FinitePositionGenerator::FinitePositionGenerator(
-    const std::vector<Position> &positions)
-    : positions_(positions) {}
-
-FinitePositionGenerator::FinitePositionGenerator(std::ifstream &is) {
-  std::regex r(
-      R"(\s*.+\s*\[\s*pos\s*=\s*"([[:digit:]]+)\s*,\s*([[:digit:]]+)\s*,\s*([[:digit:]]+)\s*!?"\s*\])");
-  std::string line;
-  while (std::getline(is, line)) {
-    std::smatch match;
-    if (std::regex_match(line, match, r)) {
-      positions_.emplace_back(std::atoi(match[1].str().c_str()),
-                              std::atoi(match[2].str().c_str()),
-                              std::atoi(match[3].str().c_str()));
+static constexpr char BINARY_MAGIC[8] = {'S', 'A', 'R', 'P',
+                                         'P', 'O', 'S', '1'};
+
+static bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' ||
+         c == '\v';
+}
+
+static bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+// RETURNS: true if the text is a possibly space padded nonempty name, the name
+// itself may contain spaces but no carriage returns.
+static bool IsNodeName(std::string_view s) {
+  std::size_t begin = 0;
+  while (begin < s.size() && IsSpace(s[begin])) {
+    ++begin;
+  }
+  if (begin == s.size()) {
+    // Only spaces, one of them has to serve as the name.
+    return s.find_first_not_of('\r') != std::string_view::npos;
+  }
+  std::size_t end = s.size();
+  while (IsSpace(s[end - 1])) {
+    --end;
+  }
+  return s.substr(begin, end - begin).find('\r') == std::string_view::npos;
+}
+
+// Parses pos="x,y,z"] part of the line, i.e. everything after '['.
+static bool ParsePositionAttribute(std::string_view s, Position *position) {
+  std::size_t i = 0;
+  auto SkipSpaces = [&]() {
+    while (i < s.size() && IsSpace(s[i])) {
+      ++i;
+    }
+  };
+  auto Expect = [&](std::string_view token) {
+    SkipSpaces();
+    if (s.substr(i, token.size()) != token) {
+      return false;
+    }
+    i += token.size();
+    return true;
+  };
+  auto ParseNumber = [&](int *number) {
+    SkipSpaces();
+    if (i >= s.size() || !IsDigit(s[i])) {
+      return false;
+    }
+    *number = 0;
+    while (i < s.size() && IsDigit(s[i])) {
+      *number = *number * 10 + (s[i++] - '0');
+    }
+    return true;
+  };
+  int x, y, z;
+  if (!Expect("pos") || !Expect("=") || !Expect("\"") || !ParseNumber(&x) ||
+      !Expect(",") || !ParseNumber(&y) || !Expect(",") || !ParseNumber(&z)) {
+    return false;
+  }
+  SkipSpaces();
+  if (i < s.size() && s[i] == '!') {
+    ++i;
+  }
+  if (i >= s.size() || s[i++] != '"' || !Expect("]")) {
+    return false;
+  }
+  if (i != s.size()) {
+    return false;
+  }
+  *position = Position(x, y, z);
+  return true;
+}
+
+std::vector<Position> FinitePositionGenerator::ParseDot(std::string_view text) {
+  std::vector<Position> positions;
+  while (!text.empty()) {
+    std::size_t line_end = text.find('\n');
+    std::string_view line = text.substr(0, line_end);
+    text.remove_prefix(line_end == std::string_view::npos ? text.size()
+                                                          : line_end + 1);
+    // Attributes follow the last '[' which has to be preceded by a name.
+    std::size_t bracket = line.rfind('[');
+    if (bracket == std::string_view::npos ||
+        !IsNodeName(line.substr(0, bracket))) {
+      continue;
+    }
+    Position position;
+    if (ParsePositionAttribute(line.substr(bracket + 1), &position)) {
+      positions.push_back(position);
+    }
+  }
+  return positions;
+}
+
+std::unique_ptr<FinitePositionGenerator> FinitePositionGenerator::FromDotFile(
+    const std::string &path) {
+  MappedFile file(path);
+  return std::make_unique<FinitePositionGenerator>(ParseDot(file.get_view()));
+}
+
+std::unique_ptr<FinitePositionGenerator>
+FinitePositionGenerator::FromBinaryFile(const std::string &path) {
+  MappedFile file(path);
+  std::string_view data = file.get_view();
+  std::vector<Position> positions;
+  uint64_t count = 0;
+  constexpr std::size_t header_size = sizeof(BINARY_MAGIC) + sizeof(count);
+  constexpr std::size_t record_size = 3 * sizeof(int32_t);
+  if (data.size() >= header_size &&
+      data.substr(0, sizeof(BINARY_MAGIC)) ==
+          std::string_view(BINARY_MAGIC, sizeof(BINARY_MAGIC))) {
+    std::memcpy(&count, data.data() + sizeof(BINARY_MAGIC), sizeof(count));
+    if (count <= (data.size() - header_size) / record_size) {
+      positions.resize(count);
+      const char *record = data.data() + header_size;
+      for (auto &position : positions) {
+        int32_t xyz[3];
+        std::memcpy(xyz, record, record_size);
+        position = Position(xyz[0], xyz[1], xyz[2]);
+        record += record_size;
+      }
     }
   }
+  return std::make_unique<FinitePositionGenerator>(std::move(positions));
+}
+
+bool FinitePositionGenerator::WriteBinaryFile(
+    const std::string &path, const std::vector<Position> &positions) {
+  std::ofstream os(path, std::ios::binary);
+  const uint64_t count = positions.size();
+  os.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+  os.write(reinterpret_cast<const char *>(&count), sizeof(count));
+  for (const auto &position : positions) {
+    const int32_t xyz[3] = {position.x, position.y, position.z};
+    os.write(reinterpret_cast<const char *>(xyz), sizeof(xyz));
+  }
+  return static_cast<bool>(os);
+}
+
+FinitePositionGenerator::FinitePositionGenerator(
+    std::vector<Position> positions)
+    : positions_(
+          std::make_shared<const std::vector<Position>>(std::move(positions))) {
 }
 
+FinitePositionGenerator::FinitePositionGenerator(PositionContainer positions)
+    : positions_(std::move(positions)) {}
+
+FinitePositionGenerator::FinitePositionGenerator(std::ifstream &is)
+    : FinitePositionGenerator(
+          ParseDot(std::string(std::istreambuf_iterator<char>(is),
+                               std::istreambuf_iterator<char>()))) {}
+
 std::pair<Position, bool> FinitePositionGenerator::Next() {
-  if (i < positions_.size()) {
-    return std::make_pair(positions_[i++], true);
+  if (i < positions_->size()) {
+    return std::make_pair((*positions_)[i++], true);
   }
   // Indicate generation end.
   return std::make_pair(Position(0, 0, 0), false);
@@ -64,4 +206,251 @@ std::unique_ptr<PositionGenerator> RandomPositionGenerator::Clone() {
   return std::make_unique<RandomPositionGenerator>(boundaries_);
 }
 
+ProceduralPositionGenerator::ProceduralPositionGenerator(
+    std::size_t candidate_count)
+    : candidate_count_(candidate_count) {}
+
+std::pair<Position, bool> ProceduralPositionGenerator::Next() {
+  while (next_ < candidate_count_) {
+    auto candidate = At(next_++);
+    if (candidate.second) {
+      return candidate;
+    }
+  }
+  // Indicate generation end.
+  return std::make_pair(Position(0, 0, 0), false);
+}
+
+uint64_t ProceduralPositionGenerator::Hash(uint64_t seed, uint64_t key1,
+                                           uint64_t key2) {
+  // Last step is a bijection of key1 so different key1 give different hashes.
+  return Mix64(Mix64(Mix64(seed + 0x9e3779b97f4a7c15ULL) + key2) + key1);
+}
+
+int ProceduralPositionGenerator::HashToRange(uint64_t hash, int from, int to) {
+  assert(from <= to);
+  if (from == to) {
+    return from;
+  }
+  return from + hash % static_cast<uint64_t>(static_cast<int64_t>(to) - from);
+}
+
+GridPositionGenerator::GridPositionGenerator(unsigned x, unsigned y,
+                                             unsigned z, uint32_t spacing,
+                                             Position origin)
+    : ProceduralPositionGenerator(static_cast<std::size_t>(x) * y * z),
+      x_(x),
+      y_(y),
+      z_(z),
+      spacing_(spacing),
+      origin_(origin) {}
+
+std::pair<Position, bool> GridPositionGenerator::At(std::size_t index) const {
+  assert(index < get_candidate_count());
+  const std::size_t i = index / (static_cast<std::size_t>(y_) * z_);
+  const std::size_t j = index / z_ % y_;
+  const std::size_t k = index % z_;
+  return std::make_pair(Position(origin_.x + spacing_ * i,
+                                 origin_.y + spacing_ * j,
+                                 origin_.z + spacing_ * k),
+                        true);
+}
+
+std::unique_ptr<PositionGenerator> GridPositionGenerator::Clone() {
+  return std::make_unique<GridPositionGenerator>(x_, y_, z_, spacing_,
+                                                 origin_);
+}
+
+UniformPositionGenerator::UniformPositionGenerator(range<Position> boundaries,
+                                                   std::size_t count,
+                                                   uint64_t seed)
+    : ProceduralPositionGenerator(count),
+      boundaries_(boundaries),
+      seed_(seed) {}
+
+range<Position> UniformPositionGenerator::GetDensityBoundaries(
+    std::size_t count, uint32_t connection_range, double neighbors) {
+  assert(neighbors > 0);
+  const double range_volume = 4.0 / 3.0 * M_PI * connection_range *
+                              connection_range * connection_range;
+  const unsigned side = std::ceil(std::cbrt(count * range_volume / neighbors));
+  return {Position(0, 0, 0), Position(side, side, side)};
+}
+
+std::pair<Position, bool> UniformPositionGenerator::At(
+    std::size_t index) const {
+  assert(index < get_candidate_count());
+  const auto &[min, max] = boundaries_;
+  return std::make_pair(
+      Position(HashToRange(Hash(seed_, index, 0), min.x, max.x),
+               HashToRange(Hash(seed_, index, 1), min.y, max.y),
+               HashToRange(Hash(seed_, index, 2), min.z, max.z)),
+      true);
+}
+
+std::unique_ptr<PositionGenerator> UniformPositionGenerator::Clone() {
+  return std::make_unique<UniformPositionGenerator>(
+      boundaries_, get_candidate_count(), seed_);
+}
+
+// RETURNS: count of cubes with given side covering [from, to], at least 1.
+static int GetCubeCount(int from, int to, uint32_t side) {
+  const int64_t extent = static_cast<int64_t>(to) - from;
+  return std::max<int64_t>(1, (extent + side - 1) / side);
+}
+
+PoissonDiskPositionGenerator::PoissonDiskPositionGenerator(
+    range<Position> boundaries, uint32_t min_distance, uint64_t seed)
+    : ProceduralPositionGenerator(
+          static_cast<std::size_t>(GetCubeCount(boundaries.first.x,
+                                                boundaries.second.x,
+                                                min_distance)) *
+          GetCubeCount(boundaries.first.y, boundaries.second.y,
+                       min_distance) *
+          GetCubeCount(boundaries.first.z, boundaries.second.z,
+                       min_distance)),
+      boundaries_(boundaries),
+      min_distance_(min_distance),
+      seed_(seed),
+      cubes_x_(GetCubeCount(boundaries.first.x, boundaries.second.x,
+                            min_distance)),
+      cubes_y_(GetCubeCount(boundaries.first.y, boundaries.second.y,
+                            min_distance)),
+      cubes_z_(GetCubeCount(boundaries.first.z, boundaries.second.z,
+                            min_distance)) {
+  assert(min_distance > 0);
+}
+
+Position PoissonDiskPositionGenerator::GetCandidate(int x, int y,
+                                                    int z) const {
+  const auto &[min, max] = boundaries_;
+  const int cube_side = min_distance_;
+  const uint64_t cube = GetPriority(x, y, z);
+  auto Coordinate = [&](int i, int cube_index, int from, int to) {
+    const int begin = from + cube_index * cube_side;
+    return HashToRange(Hash(seed_, cube, i), begin,
+                       std::max(begin, std::min(begin + cube_side, to)));
+  };
+  return Position(Coordinate(1, x, min.x, max.x),
+                  Coordinate(2, y, min.y, max.y),
+                  Coordinate(3, z, min.z, max.z));
+}
+
+uint64_t PoissonDiskPositionGenerator::GetPriority(int x, int y,
+                                                   int z) const {
+  const std::size_t cube =
+      (static_cast<std::size_t>(x) * cubes_y_ + y) * cubes_z_ + z;
+  return Hash(seed_, cube);
+}
+
+std::pair<Position, bool> PoissonDiskPositionGenerator::At(
+    std::size_t index) const {
+  assert(index < get_candidate_count());
+  const int x = index / (static_cast<std::size_t>(cubes_y_) * cubes_z_);
+  const int y = index / cubes_z_ % cubes_y_;
+  const int z = index % cubes_z_;
+  const Position candidate = GetCandidate(x, y, z);
+  const uint64_t priority = GetPriority(x, y, z);
+  const int64_t min_distance_squared =
+      static_cast<int64_t>(min_distance_) * min_distance_;
+  for (int i = std::max(0, x - 1); i <= std::min(cubes_x_ - 1, x + 1); ++i) {
+    for (int j = std::max(0, y - 1); j <= std::min(cubes_y_ - 1, y + 1); ++j) {
+      for (int k = std::max(0, z - 1); k <= std::min(cubes_z_ - 1, z + 1);
+           ++k) {
+        if (GetPriority(i, j, k) > priority &&
+            Position::DistanceSquared(candidate, GetCandidate(i, j, k)) <
+                min_distance_squared) {
+          return std::make_pair(candidate, false);
+        }
+      }
+    }
+  }
+  return std::make_pair(candidate, true);
+}
+
+std::unique_ptr<PositionGenerator> PoissonDiskPositionGenerator::Clone() {
+  return std::make_unique<PoissonDiskPositionGenerator>(boundaries_,
+                                                        min_distance_, seed_);
+}
+
+ClusteredPositionGenerator::ClusteredPositionGenerator(
+    range<Position> boundaries, std::size_t count, std::size_t cluster_count,
+    uint32_t cluster_radius, uint64_t seed)
+    : ProceduralPositionGenerator(count),
+      boundaries_(boundaries),
+      cluster_count_(cluster_count),
+      cluster_radius_(cluster_radius),
+      seed_(seed) {
+  assert(cluster_count > 0);
+}
+
+std::pair<Position, bool> ClusteredPositionGenerator::At(
+    std::size_t index) const {
+  assert(index < get_candidate_count());
+  const auto &[min, max] = boundaries_;
+  const int mins[3] = {min.x, min.y, min.z};
+  const int maxs[3] = {max.x, max.y, max.z};
+  // Clusters use keys above the ones of positions.
+  const uint64_t cluster = get_candidate_count() + index % cluster_count_;
+  const int radius = cluster_radius_;
+  int offset[3] = {0, 0, 0};
+  for (uint64_t attempt = 0;; attempt += 3) {
+    int64_t distance_squared = 0;
+    for (int i = 0; i < 3; ++i) {
+      // Flat boundaries stay flat.
+      offset[i] = mins[i] == maxs[i]
+                      ? 0
+                      : HashToRange(Hash(seed_, index, attempt + i), -radius,
+                                    radius + 1);
+      distance_squared += static_cast<int64_t>(offset[i]) * offset[i];
+    }
+    if (distance_squared <= static_cast<int64_t>(radius) * radius) {
+      break;
+    }
+  }
+  int coordinates[3];
+  for (int i = 0; i < 3; ++i) {
+    const int center = HashToRange(Hash(seed_, cluster, i), mins[i], maxs[i]);
+    coordinates[i] =
+        std::clamp(center + offset[i], mins[i], std::max(mins[i], maxs[i] - 1));
+  }
+  return std::make_pair(
+      Position(coordinates[0], coordinates[1], coordinates[2]), true);
+}
+
+std::unique_ptr<PositionGenerator> ClusteredPositionGenerator::Clone() {
+  return std::make_unique<ClusteredPositionGenerator>(
+      boundaries_, get_candidate_count(), cluster_count_, cluster_radius_,
+      seed_);
+}
+
+std::vector<Position> GeneratePositions(
+    const ProceduralPositionGenerator &generator, ThreadPool &thread_pool) {
+  const std::size_t candidate_count = generator.get_candidate_count();
+  // Candidates are split to more blocks than threads to balance the load.
+  const std::size_t block_count = std::min<std::size_t>(
+      candidate_count, 16 * thread_pool.get_thread_count());
+  std::vector<std::vector<Position>> blocks(block_count);
+  if (block_count > 0) {
+    thread_pool.ParallelFor(block_count, [&](std::size_t begin,
+                                             std::size_t end) {
+      for (std::size_t block = begin; block < end; ++block) {
+        const std::size_t first = candidate_count * block / block_count;
+        const std::size_t last = candidate_count * (block + 1) / block_count;
+        for (std::size_t i = first; i < last; ++i) {
+          auto [position, accepted] = generator.At(i);
+          if (accepted) {
+            blocks[block].push_back(position);
+          }
+        }
+      }
+    });
+  }
+  std::vector<Position> positions;
+  for (const auto &block : blocks) {
+    positions.insert(positions.end(), block.cbegin(), block.cend());
+  }
+  return positions;
+}
+
 }  // namespace simulation
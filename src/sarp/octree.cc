@@ -6,7 +6,6 @@
 
 #include <algorithm>
 #include <cmath>
-#include <limits>
 
 #include "structure/simulation.h"
 
@@ -14,49 +13,65 @@ namespace simulation {
 
 constexpr uint32_t octree_factor = 2;
 
+// Deepest octree for which addresses are computed from Morton codes, codes of
+// all three axes then fit into 64 bits.
+constexpr uint32_t max_morton_depth = 21;
+
 OctreeAddressingEvent::OctreeAddressingEvent(const Time time, TimeType type,
-                                             Network &network)
-    : Event(time, type), network_(network) {}
+                                             Network &network,
+                                             Time address_lifetime,
+                                             std::shared_ptr<OctreeCells> cells)
+    : Event(time, type),
+      network_(network),
+      address_lifetime_(address_lifetime),
+      cells_(std::move(cells)) {}
 
 void OctreeAddressingEvent::Execute(Env &env) {
-  RecomputeUniqueAddresses(network_,
-                           env.parameters.get_general().boundaries.first,
-                           env.parameters.get_general().boundaries.second);
+  network_.get_mobility().UpdatePositions(env);
+  const Time now = env.simulation.get_current_time();
+  RecomputeUniqueAddresses(env.parameters, network_, now);
+  if (address_lifetime_ > 0 && now >= address_lifetime_) {
+    ExpireAddresses(env, now - address_lifetime_);
+  }
+}
+
+void OctreeAddressingEvent::ExpireAddresses(Env &env, Time time) {
+  for (NodeID id : network_.get_boot_order()) {
+    network_.get_node(id)->ExpireAddresses(env, time);
+  }
 }
 
 std::ostream &OctreeAddressingEvent::Print(std::ostream &os) const {
   return os << time_ << ":sarp_address_update:" << '\n';
 }
 
-OctreeAddressingEventGenerator::OctreeAddressingEventGenerator(range<Time> time,
-                                                               Time period,
-                                                               Network &network)
+OctreeAddressingEventGenerator::OctreeAddressingEventGenerator(
+    range<Time> time, Time period, Network &network,
+    std::size_t address_lifetime)
     : time_(time),
       period_(period),
       network_(network),
-      virtual_time_(time_.first) {}
+      address_lifetime_(address_lifetime),
+      virtual_time_(time_.first),
+      cells_(std::make_shared<OctreeCells>()) {}
 
 std::unique_ptr<Event> OctreeAddressingEventGenerator::Next() {
   if (virtual_time_ >= time_.second) {
     return nullptr;
   }
   auto event = std::make_unique<OctreeAddressingEvent>(
-      virtual_time_, TimeType::ABSOLUTE, network_);
+      virtual_time_, TimeType::ABSOLUTE, network_,
+      address_lifetime_ * period_, cells_);
   virtual_time_ += period_;
   return std::move(event);
 }
 
-static double MinNodeDistance(const Network &network) {
+static double MinNodeDistance(const Parameters &parameters, Network &network) {
   assert(network.get_nodes().size() >= 2);
-  double min_node_distance = std::numeric_limits<int>::max();
-  auto &nodes = network.get_nodes();
-  for (std::size_t i = 0; i < nodes.size(); ++i) {
-    for (std::size_t j = i + 1; j < nodes.size(); ++j) {
-      auto distance = Position::Distance(nodes[i]->get_position(),
-                                         nodes[j]->get_position());
-      min_node_distance = std::min(min_node_distance, distance);
-    }
-  }
+  auto [node1, node2] = network.FindClosestPair(parameters);
+  double min_node_distance =
+      Position::Distance(network.get_node(node1)->get_position(),
+                         network.get_node(node2)->get_position());
   // If two nodes are very close to each other then the depth of the octree will
   // be too big -> set some granularity with settin minimal min_node_distance to
   // 1 and therefore setting the limit on address length.
@@ -115,18 +130,89 @@ static Address GetAddress(uint32_t octree_depth, Position nodes_position,
   return address;
 }
 
-void OctreeAddressingEvent::RecomputeUniqueAddresses(Network &network,
-                                                     Position min_pos,
-                                                     Position max_pos) {
+// RETURNS: index of the cell containing coordinate among 2^depth cells which
+// divide [0, max], max belongs to the last one.
+static uint64_t CellIndex(int coordinate, int max, uint32_t depth) {
+  if (max <= 0) {
+    return 0;
+  }
+  uint64_t index = (static_cast<uint64_t>(coordinate) << depth) / max;
+  return std::min(index, (uint64_t(1) << depth) - 1);
+}
+
+static bool IsInRange(int coordinate, int max) {
+  return coordinate >= 0 && coordinate <= std::max(max, 0);
+}
+
+// RETURNS: Morton code of the cell containing the node at given depth, or
+// OctreeCells::no_code if the octree is too deep or the node lies out of the
+// boundaries.
+static uint64_t MortonCellCode(uint32_t octree_depth, Position nodes_position,
+                               Position max_pos) {
+  if (octree_depth > max_morton_depth ||
+      !IsInRange(nodes_position.x, max_pos.x) ||
+      !IsInRange(nodes_position.y, max_pos.y) ||
+      !IsInRange(nodes_position.z, max_pos.z)) {
+    return OctreeCells::no_code;
+  }
+  return MortonCode(CellIndex(nodes_position.x, max_pos.x, octree_depth),
+                    CellIndex(nodes_position.y, max_pos.y, octree_depth),
+                    CellIndex(nodes_position.z, max_pos.z, octree_depth));
+}
+
+// Computes the same address as GetAddress with integer arithmetic. Octree
+// addresses are Morton codes of the cell at given depth since each component
+// takes one bit of the cell index for each axis, x being the lowest one.
+static Address GetMortonAddress(uint32_t octree_depth, uint64_t code) {
+  assert(octree_depth <= max_morton_depth && code != OctreeCells::no_code);
+  Address address(octree_depth);
+  for (uint32_t i = 0; i < octree_depth; ++i) {
+    address[i] = (code >> (3 * (octree_depth - 1 - i))) & 0x7;
+  }
+  return address;
+}
+
+void OctreeAddressingEvent::RecomputeUniqueAddresses(
+    const Parameters &parameters, Network &network, Time time) {
   if (network.get_nodes().size() < 2) {
     return;
   }
-  uint32_t min_distance = MinNodeDistance(network);
+  const auto [min_pos, max_pos] = parameters.get_general().boundaries;
+  uint32_t min_distance = MinNodeDistance(parameters, network);
   std::size_t depth = CountOctreeDepth(network, min_distance, min_pos, max_pos);
-  // Now that we know the depth assign address to each node.
-  for (auto &node : network.get_nodes()) {
-    auto new_address = GetAddress(depth, node->get_position(), max_pos);
-    node->AddAddress(new_address);
+  OctreeCells local_cells;
+  OctreeCells &cells = cells_ ? *cells_ : local_cells;
+  if (cells.depth != depth) {
+    cells.depth = depth;
+    cells.entries.clear();
+  }
+  // Now that we know the depth compute address of each node in parallel. Only
+  // the cell is computed for nodes which stayed in it since the last time.
+  const auto &boot_order = network.get_boot_order();
+  cells.entries.resize(boot_order.size(), {0, OctreeCells::no_code, {}});
+  auto ComputeRange = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      OctreeCells::Entry &entry = cells.entries[i];
+      const Position position = network.get_node(boot_order[i])->get_position();
+      const uint64_t code = MortonCellCode(depth, position, max_pos);
+      if (entry.node == boot_order[i] && entry.code == code &&
+          code != OctreeCells::no_code) {
+        continue;
+      }
+      entry.node = boot_order[i];
+      entry.code = code;
+      entry.address = code == OctreeCells::no_code
+                          ? GetAddress(depth, position, max_pos)
+                          : GetMortonAddress(depth, code);
+    }
+  };
+  network.GetThreadPool(parameters.get_general().worker_threads)
+      .ParallelFor(boot_order.size(), ComputeRange);
+  // Assign them in boot order, addresses of nodes which stay in the same cell
+  // are only refreshed.
+  for (std::size_t i = 0; i < boot_order.size(); ++i) {
+    network.get_node(boot_order[i])
+        ->RefreshAddress(cells.entries[i].address, time);
   }
 }
 
@@ -4,8 +4,11 @@
 
 #include "sarp/routing.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <iterator>
+#include <set>
 
 #include "sarp/update_packet.h"
 #include "structure/event.h"
@@ -16,133 +19,124 @@ namespace simulation {
 
 SarpRouting::SarpRouting(Node &node) : Routing(node) {}
 
-static std::size_t CommonPrefixLength(const Address addr1,
-                                      const Address addr2) {
-  std::size_t max_size = std::max(addr1.size(), addr2.size());
-  for (std::size_t i = 0; i < max_size; ++i) {
-    if (addr1[i] != addr2[i]) {
-      return i;
-    }
-  }
-  return max_size;
-}
-
 Node *SarpRouting::Route(Env &env, Packet &packet) {
   const Address &destination_address = packet.get_destination_address();
 
-  auto i = table_.Find(destination_address);
-  if (i != table_.end()) {
-    return i->second.via_node;
-  }
-
-  // Find longest common prefix addresses in forwarding table.
-  auto it = table_.cbegin();
-  if (it == table_.cend()) {
+  const auto match = GetForwardingTable().Lookup(destination_address);
+  if (match.via_node == ForwardingTable::NO_HOP) {
     return nullptr;
   }
-  std::size_t lcp = 0;
-  auto best_match = it->second;
-  while (it != table_.cend()) {
-    auto cp = CommonPrefixLength(destination_address, it->first);
-    if (cp > lcp) {
-      lcp = cp;
-      best_match = it->second;
-    } else if (cp == lcp) {
-      if (it->second.cost.PreferTo(best_match.cost) &&
-          it->second.via_node != &node_) {
-        best_match = it->second;
-      }
-    } else {  // cp < lcp
-      break;
-    }
-    ++it;
-  }
-  if (best_match.via_node == &node_) {
+  // Exact matches are followed even to the node itself.
+  if (match.via_node == node_->get_id() && !match.exact) {
     env.stats.RegisterReflexiveRoutingResult();
     return nullptr;  // There is no reflexive traffic.
   }
-  return best_match.via_node;
+  return env.network->get_node(match.via_node);
 }
 
-void SarpRouting::Process(Env &env, Packet &packet, Node *from_node) {
+void SarpRouting::Process(Env &env, Packet &packet, NodeID from_node) {
   assert(packet.IsRoutingUpdate());
   env.stats.RegisterRoutingOverheadDelivered();
-  auto &update_packet = dynamic_cast<SarpUpdatePacket &>(packet);
-  last_updates_[from_node] = update_packet.RetrieveUpdate();
+  const auto &parameters = env.parameters.get_sarp_parameters();
+  if (parameters.digest_exchange) {
+    if (const auto *request =
+            dynamic_cast<const SarpDigestRequestPacket *>(&packet)) {
+      // The neighbor may have left since it sent the request.
+      if (node_->get_neighbors().contains(from_node)) {
+        SendDigestUpdate(env, request->get_held_digest(), from_node);
+      }
+      return;
+    }
+    const auto &update_packet =
+        dynamic_cast<const SarpDigestUpdatePacket &>(packet);
+    if (!ReceiveDigestUpdate(update_packet, from_node, env.address_pool)) {
+      // The update held has changed since the request, ask again.
+      RequestUpdate(env, from_node);
+      return;
+    }
+  } else {
+    auto &update_packet = dynamic_cast<SarpUpdatePacket &>(packet);
+    last_updates_[from_node] = update_packet.RetrieveUpdate();
+  }
   if (last_updates_.size() == neighbor_count_) {
-    change_occured_ = BatchProcessUpdate(env.parameters.get_sarp_parameters());
+    change_occured_ = BatchProcessUpdate(parameters, env.address_pool);
+    // The table is rebuilt by every batch even if the change is negligible.
+    fib_outdated_ = true;
     if (change_occured_) {
-      CreateUpdateMirror();
-      NotifyChange();
+      CreateUpdateMirror(parameters, env.address_pool);
+      NotifyChange(env);
     }
   }
 }
 
 void SarpRouting::Init(Env &env) {
-  for (const auto &address : node_.get_addresses()) {
+  for (const auto &address : node_->get_addresses()) {
     InsertInitialAddress(address, MIN_COST);
   }
-  CreateUpdateMirror();
+  fib_outdated_ = true;
+  CreateUpdateMirror(env.parameters.get_sarp_parameters(), env.address_pool);
   CheckPeriodicUpdate(env);
 }
 
-void SarpRouting::SendUpdate(Env &env, Node *neighbor) {
-  assert(node_.get_neighbors().contains(neighbor));
-  assert(neighbor != &node_);
+void SarpRouting::SendUpdate(Env &env, NodeID neighbor) {
+  assert(node_->get_neighbors().contains(neighbor));
+  assert(neighbor != node_->get_id());
   // Create update packet.
   std::unique_ptr<Packet> packet = std::make_unique<SarpUpdatePacket>(
-      node_.get_address(), neighbor->get_address(), update_mirror_);
+      node_->get_address(), env.network->get_node(neighbor)->get_address(),
+      update_mirror_);
+  SendToNeighbor(env, neighbor, std::move(packet));
+}
+
+void SarpRouting::SendToNeighbor(Env &env, NodeID neighbor,
+                                 std::unique_ptr<Packet> packet) {
   // Register to statistics before we move packet away.
   env.stats.RegisterRoutingOverheadSend();
   env.stats.RegisterRoutingOverheadSize(packet->get_size());
   // Schedule immediate recieve on neighbor to bypass Node::Send() which calls
   // Routing::Route which is not desired.
   env.simulation.ScheduleEvent(std::make_unique<RecvEvent>(
-      1, TimeType::RELATIVE, node_, *neighbor, std::move(packet)));
+      1, TimeType::RELATIVE, node_->get_id(), neighbor, std::move(packet)));
 }
 
-void SarpRouting::UpdateNeighbors(Env &env,
-                                  const std::set<Node *> &current_neighbors) {
-  // Search for invalid records in routing table.
-  for (auto it = table_.begin(); it != table_.end();
-       /* no increment */) {
-    Node *neighbor = it->second.via_node;
-    if (node_.IsConnectedTo(*neighbor,
-                            env.parameters.get_general().connection_range)) {
-      assert(current_neighbors.contains(neighbor));
-      ++it;
-    } else {
-      assert(!current_neighbors.contains(neighbor));
-      it = table_.Erase(it);
-    }
+void SarpRouting::UpdateNeighbors(Env &, const std::vector<NodeID> &added,
+                                  const std::vector<NodeID> &removed) {
+  // Drop records through removed neighbors and clear their update history.
+  for (NodeID neighbor : removed) {
+    table_.EraseVia(neighbor);
+    last_updates_.erase(neighbor);
+    held_digests_.erase(neighbor);
   }
-  // Now clear the update history of invalid records.
-  for (auto it = last_updates_.cbegin(); it != last_updates_.cend();
-       /* no increment */) {
-    Node *neighbor = it->first;
-    if (node_.IsConnectedTo(*neighbor,
-                            env.parameters.get_general().connection_range)) {
-      assert(current_neighbors.contains(neighbor));
-      ++it;
-    } else {
-      assert(!current_neighbors.contains(neighbor));
-      it = last_updates_.erase(it);
-    }
+  if (!removed.empty()) {
+    fib_outdated_ = true;
+    batch_valid_ = false;
   }
   // Set the neighbor count to know the new batch size.
-  neighbor_count_ = current_neighbors.size() - 1;  // -1 for reflexive node
+  neighbor_count_ = node_->get_neighbors().size() - 1;  // -1 for reflexive node
   // If there are new neighbors set change_occured for next CheckPeriodicUpdate.
-  const auto &old_neighbors = node_.get_neighbors();
-  for (const auto current_neighbor : current_neighbors) {
-    if (old_neighbors.contains(current_neighbor) == false) {
-      change_occured_ = true;
-      break;
-    }
+  if (!added.empty()) {
+    change_occured_ = true;
   }
 }
 
 void SarpRouting::UpdateAddresses() { change_occured_ = true; }
 
+void SarpRouting::WithdrawAddresses(Env &env,
+                                    const std::vector<Address> &addresses) {
+  // The next batch rebuilds local records from addresses of the node, remove
+  // them right away so that updates sent before it leave them out too.
+  for (const Address &address : addresses) {
+    auto record = table_.Find(address);
+    if (record != table_.end() && record->via_node == node_->get_id()) {
+      table_.Erase(record);
+    }
+  }
+  fib_outdated_ = true;
+  batch_valid_ = false;
+  CreateUpdateMirror(env.parameters.get_sarp_parameters(), env.address_pool);
+  change_occured_ = true;
+}
+
 static Address LCP(const std::set<Address> &set) {
   assert(!set.empty());
   if (set.size() == 1) {
@@ -150,24 +144,32 @@ static Address LCP(const std::set<Address> &set) {
   }
   auto &first = *set.begin();
   auto &last = *set.rbegin();
-  auto max_prefix = std::min(first.size(), last.size());
-
-  std::size_t lcp;
-  for (lcp = 0; lcp < max_prefix && first[lcp] == last[lcp]; ++lcp)
-    ;
+  const std::size_t lcp = first.CommonPrefixLength(last);
   return Address(first.cbegin(), first.cbegin() + lcp);
 }
 
-static Address PickNewAddress(const std::set<Address> &neighbor_addresses,
-                              AddressComponent min) {
-  Address new_address = *neighbor_addresses.rbegin();
-  new_address.push_back(min);
-  return new_address;
+// RETURNS: the greatest neighbor address which can be prolonged, prolonged by
+// min to an address not in the table, false if there is none.
+static std::pair<Address, bool> PickNewAddress(
+    const SarpTable &table, const std::set<Address> &neighbor_addresses,
+    AddressComponent min) {
+  for (auto it = neighbor_addresses.rbegin(); it != neighbor_addresses.rend();
+       ++it) {
+    if (it->size() == Address::MAX_SIZE) {
+      continue;
+    }
+    Address new_address = *it;
+    new_address.push_back(min);
+    if (!table.Contains(new_address)) {
+      return {new_address, true};
+    }
+  }
+  return {Address(), false};
 }
 
 std::pair<Address, bool> SarpRouting::SelectAddress(Env &env) const {
 #ifdef DEBUG
-  std::cerr << "\nAddressSelectionProcedure for " << node_ << '\n';
+  std::cerr << "\nAddressSelectionProcedure for " << *node_ << '\n';
   std::cerr << "Table dump:\n";
   Dump(std::cerr);
   std::cerr << "\nNeighbor addresses: ";
@@ -175,9 +177,9 @@ std::pair<Address, bool> SarpRouting::SelectAddress(Env &env) const {
   // Find the parent node of all direct neighbor records.
   std::set<Address> neighbor_addresses;  // Sorted.
   for (auto it = table_.cbegin(); it != table_.cend(); ++it) {
-    if (it->second.cost.Mean() ==
+    if (it->cost.Mean() ==
         env.parameters.get_sarp_parameters().neighbor_cost.Mean()) {
-      auto [inserted_address, success] = neighbor_addresses.insert(it->first);
+      auto [inserted_address, success] = neighbor_addresses.insert(it->address);
       assert(success);
 #ifdef DEBUG
       std::cerr << *inserted_address << ' ';
@@ -191,19 +193,18 @@ std::pair<Address, bool> SarpRouting::SelectAddress(Env &env) const {
   if (neighbor_addresses.empty()) {
     // Perform narrowing on the Node::ID to AddressComponent.
 #ifdef DEBUG
-    std::cerr << "Pick default address: " << node_.get_id() << '\n';
+    std::cerr << "Pick default address: " << node_->get_id() << '\n';
 #endif
-    return {Address({static_cast<AddressComponent>(node_.get_id())}), true};
+    return {Address({static_cast<AddressComponent>(node_->get_id())}), true};
   }
   // Find LCP of all neighbor records.
   Address lcp_address = LCP(neighbor_addresses);
   if (lcp_address.size() == 0) {
-    auto new_address = PickNewAddress(neighbor_addresses, 0);
+    const auto picked = PickNewAddress(table_, neighbor_addresses, 0);
 #ifdef DEBUG
-    std::cerr << "LCP == 0 prolong one neighbor: " << new_address << '\n';
+    std::cerr << "LCP == 0 prolong one neighbor: " << picked.first << '\n';
 #endif
-    assert(table_.Contains(new_address) == false);
-    return {new_address, true};
+    return picked;
   }
   // LCP address should be present since all records have generalized versions
   // of them.
@@ -220,66 +221,408 @@ std::pair<Address, bool> SarpRouting::SelectAddress(Env &env) const {
   }
   // If there is no free address among subtree of all neighbors pick the first
   // neighbor and pick a longer address from it.
-  auto new_address = PickNewAddress(neighbor_addresses, 0);
+  // Neighbors at full length cannot be prolonged, if none can the node keeps
+  // its address.
+  const auto picked = PickNewAddress(table_, neighbor_addresses, 0);
 #ifdef DEBUG
-  std::cerr << "No freee address - prolong one neighbor " << new_address
+  std::cerr << "No freee address - prolong one neighbor " << picked.first
             << '\n';
 #endif
-  assert(table_.Contains(new_address) == false);
-  return {new_address, true};
+  return picked;
 }
 
 void SarpRouting::Dump(std::ostream &os) const {
-  os << "Routing table dump: " << node_ << '\n'
+  os << "Routing table dump: " << *node_ << '\n'
      << "address,\t"
      << "cost,\t\t\t\t\t"
      << "via_node, "
      << "generalize\n";
   for (auto record = table_.cbegin(); record != table_.cend(); ++record) {
-    os << record->first << "\t\t" << record->second.cost << "\t\t"
-       << *record->second.via_node << "\n";
+    os << record->address << "\t\t" << record->cost << "\t\t" << '<'
+       << record->via_node << ">\n";
   }
 }
 
 void SarpRouting::InsertInitialAddress(Address address, const Cost &cost) {
   while (address.size() > 0) {
-    (void)table_.Insert(address, cost, &node_);
+    (void)table_.Insert(address, cost, node_->get_id());
     address.pop_back();
   }
 }
 
-bool SarpRouting::BatchProcessUpdate(const Parameters::Sarp &parameters) {
+bool SarpRouting::BatchProcessUpdate(const Parameters::Sarp &parameters,
+                                     AddressPool &pool) {
   assert(neighbor_count_ == last_updates_.size());
+  // Inputs are compared only once batches settle, otherwise most of them
+  // change anyway.
+  std::vector<AddressID> changed;
+  bool stable = false;
+  if (!batch_changed_) {
+    changed = FindChangedAddresses(pool);
+    stable = changed.size() <= MAX_CHANGED_RATIO * table_.Size();
+  }
+  bool change_occured;
+  if (stable && batch_valid_) {
+    std::vector<Address> changed_addresses;
+    changed_addresses.reserve(changed.size());
+    for (AddressID address : changed) {
+      changed_addresses.push_back(pool.Get(address));
+    }
+    std::sort(changed_addresses.begin(), changed_addresses.end());
+    change_occured = UpdateBatch(parameters, pool, changed_addresses);
+  } else {
+    change_occured = RebuildBatch(parameters, pool, stable);
+  }
+  batch_updates_ = std::move(last_updates_);
+  last_updates_.clear();
+  batch_addresses_ = node_->get_addresses();
+  batch_valid_ = stable;
+  batch_changed_ = change_occured;
+  return change_occured;
+}
+
+bool SarpRouting::RebuildBatch(const Parameters::Sarp &parameters,
+                               AddressPool &pool, bool keep_tables) {
   auto &inputs = last_updates_;
   SarpTable output;
   // Insert local routs to input.
-  for (auto address : node_.get_addresses()) {
-    output.AddRecord(address, MIN_COST, &node_, &node_);
-    address.pop_back();
-    while (address.size() > 0) {
-      output.AddRecord(address, MAX_COST, &node_, &node_);
-      address.pop_back();
+  const NodeID self = node_->get_id();
+  for (const auto &address : node_->get_addresses()) {
+    output.AddRecord(address, MIN_COST, self, self);
+    for (AddressID prefix = pool.GetParent(pool.Intern(address));
+         prefix != AddressPool::ROOT; prefix = pool.GetParent(prefix)) {
+      output.AddRecord(pool.Get(prefix), MAX_COST, self, self);
     }
   }
   // Create table of shortest routes from all updates.
   for (const auto &[via_node, update_table] : inputs) {
     for (const auto &[address, cost] : update_table) {
       Cost actual_cost = Cost::AddCosts(cost, parameters.neighbor_cost);
-      output.AddRecord(address, actual_cost, via_node, &node_);
+      output.AddRecord(pool.Get(address), actual_cost, via_node, self);
     }
   }
-  output.Generalize(&node_);
-  output.Compact(parameters.compact_treshold,
-                 parameters.min_standard_deviation);
+  if (keep_tables) {
+    merged_ = output;
+    output.Generalize(self);
+    generalized_ = output;
+    output.Compact(parameters.compact_treshold,
+                   parameters.min_standard_deviation);
+  } else {
+    output.GeneralizeAndCompact(self, parameters.compact_treshold,
+                                parameters.min_standard_deviation);
+  }
   bool change_occured = table_.NeedUpdate(output, parameters.update_treshold,
                                           parameters.ratio_variance_treshold);
-  table_ = output;
-  last_updates_.clear();
+  table_ = std::move(output);
   return change_occured;
 }
 
-void SarpRouting::CreateUpdateMirror() {
-  update_mirror_ = table_.CreateUpdate();
+// Appends addresses of records which are in only one of the updates or whose
+// costs differ. Both updates are sorted by addresses.
+static void AddChangedAddresses(const SarpUpdate &old_update,
+                                const SarpUpdate &new_update,
+                                const AddressPool &pool,
+                                std::vector<AddressID> &changed) {
+  auto old_record = old_update.cbegin();
+  auto new_record = new_update.cbegin();
+  while (old_record != old_update.cend() && new_record != new_update.cend()) {
+    if (old_record->address == new_record->address) {
+      if (old_record->cost != new_record->cost) {
+        changed.push_back(new_record->address);
+      }
+      ++old_record;
+      ++new_record;
+    } else if (pool.Get(old_record->address) < pool.Get(new_record->address)) {
+      changed.push_back((old_record++)->address);
+    } else {
+      changed.push_back((new_record++)->address);
+    }
+  }
+  for (; old_record != old_update.cend(); ++old_record) {
+    changed.push_back(old_record->address);
+  }
+  for (; new_record != new_update.cend(); ++new_record) {
+    changed.push_back(new_record->address);
+  }
+}
+
+std::vector<AddressID> SarpRouting::FindChangedAddresses(
+    AddressPool &pool) const {
+  const auto &addresses = node_->get_addresses();
+  // Local records of added and removed addresses include their prefixes.
+  std::vector<AddressID> changed;
+  std::vector<Address> changed_addresses;
+  std::set_symmetric_difference(
+      batch_addresses_.cbegin(), batch_addresses_.cend(), addresses.cbegin(),
+      addresses.cend(), std::back_inserter(changed_addresses));
+  for (const Address &address : changed_addresses) {
+    for (AddressID id = pool.Intern(address); id != AddressPool::ROOT;
+         id = pool.GetParent(id)) {
+      changed.push_back(id);
+    }
+  }
+  const SarpUpdate no_update;
+  for (const auto &[via_node, update] : last_updates_) {
+    auto old_update = batch_updates_.find(via_node);
+    AddChangedAddresses(
+        old_update != batch_updates_.end() ? old_update->second : no_update,
+        update, pool, changed);
+  }
+  for (const auto &[via_node, old_update] : batch_updates_) {
+    if (!last_updates_.contains(via_node)) {
+      AddChangedAddresses(old_update, no_update, pool, changed);
+    }
+  }
+  std::sort(changed.begin(), changed.end());
+  changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+  return changed;
+}
+
+bool SarpRouting::UpdateBatch(const Parameters::Sarp &parameters,
+                              AddressPool &pool,
+                              const std::vector<Address> &changed) {
+  const NodeID self = node_->get_id();
+  const auto &addresses = node_->get_addresses();
+  // Select the cheapest record of each changed address in the same order as
+  // RebuildBatch does.
+  std::set<Address> prefixes;
+  for (Address address : addresses) {
+    for (address.pop_back(); !address.empty(); address.pop_back()) {
+      prefixes.insert(address);
+    }
+  }
+  auto AddressLessThan = [&pool](const SarpUpdateRecord &record,
+                                 const Address &address) {
+    return pool.Get(record.address) < address;
+  };
+  std::vector<Address> merged_changes;
+  for (const Address &address : changed) {
+    bool found = true;
+    Cost cost = MIN_COST;
+    NodeID via_node = self;
+    if (!addresses.contains(address)) {
+      found = prefixes.contains(address);
+      cost = MAX_COST;
+    }
+    for (const auto &[neighbor, update] : last_updates_) {
+      auto record = std::lower_bound(update.cbegin(), update.cend(), address,
+                                     AddressLessThan);
+      if (record == update.cend() || pool.Get(record->address) != address) {
+        continue;
+      }
+      Cost actual_cost = Cost::AddCosts(record->cost, parameters.neighbor_cost);
+      if (!found || actual_cost.PreferTo(cost)) {
+        found = true;
+        cost = actual_cost;
+        via_node = neighbor;
+      }
+    }
+    bool merged_change = false;
+    if (found) {
+      merged_change = merged_.Assign(address, cost, via_node);
+    } else if (auto record = merged_.Find(address); record != merged_.end()) {
+      merged_.Erase(record);
+      merged_change = true;
+    }
+    if (merged_change) {
+      merged_changes.push_back(address);
+    }
+  }
+  const auto generalized_changes =
+      generalized_.Regeneralize(merged_, merged_changes, self);
+  return table_.Recompact(generalized_, generalized_changes,
+                          parameters.compact_treshold,
+                          parameters.min_standard_deviation,
+                          parameters.update_treshold);
+}
+
+const ForwardingTable &SarpRouting::GetForwardingTable() {
+  if (fib_outdated_) {
+    fib_ = table_.CompileForwardingTable(node_->get_id());
+    fib_outdated_ = false;
+  }
+  return fib_;
+}
+
+// RETURNS: digest of the addresses and costs of the update.
+static Digest UpdateDigest(const SarpUpdate &update, const AddressPool &pool) {
+  Digest digest = 0;
+  for (const SarpUpdateRecord &record : update) {
+    digest = MixDigest(digest + MixDigest(pool.Get(record.address).Hash() +
+                                          CostDigest(record.cost)));
+  }
+  // 0 stands for no records.
+  return digest != 0 || update.empty() ? digest : 1;
+}
+
+// Keeps costs of the old update which differ from the new ones by less than
+// the quantum in both mean and variance. Both updates are sorted.
+static void KeepCloseCosts(const SarpUpdate &old_update, SarpUpdate &update,
+                           double quantum, const AddressPool &pool) {
+  auto old_record = old_update.cbegin();
+  for (SarpUpdateRecord &record : update) {
+    const Address &address = pool.Get(record.address);
+    while (old_record != old_update.cend() &&
+           pool.Get(old_record->address) < address) {
+      ++old_record;
+    }
+    if (old_record != old_update.cend() &&
+        old_record->address == record.address &&
+        std::abs(old_record->cost.Mean() - record.cost.Mean()) < quantum &&
+        std::abs(old_record->cost.Variance() - record.cost.Variance()) <
+            quantum) {
+      record.cost = old_record->cost;
+    }
+  }
+}
+
+// Appends records of the update which are not in the old one with the same
+// cost and addresses of records of the old update which are not in the new
+// one. All of them are sorted by addresses.
+static void DiffUpdates(const SarpUpdate &old_update, const SarpUpdate &update,
+                        const AddressPool &pool, SarpUpdate &changed,
+                        std::vector<AddressID> &removed) {
+  auto old_record = old_update.cbegin();
+  for (const SarpUpdateRecord &record : update) {
+    const Address &address = pool.Get(record.address);
+    while (old_record != old_update.cend() &&
+           pool.Get(old_record->address) < address) {
+      removed.push_back(old_record->address);
+      ++old_record;
+    }
+    if (old_record != old_update.cend() &&
+        old_record->address == record.address) {
+      if (old_record->cost != record.cost) {
+        changed.push_back(record);
+      }
+      ++old_record;
+    } else {
+      changed.push_back(record);
+    }
+  }
+  for (; old_record != old_update.cend(); ++old_record) {
+    removed.push_back(old_record->address);
+  }
+}
+
+// RETURNS: the update with changed records set and removed ones left out.
+// All of them are sorted by addresses.
+static SarpUpdate ApplyChanges(const SarpUpdate &update,
+                               const SarpUpdate &changed,
+                               const std::vector<AddressID> &removed,
+                               const AddressPool &pool) {
+  SarpUpdate result;
+  result.reserve(update.size() + changed.size());
+  auto changed_record = changed.cbegin();
+  auto removed_address = removed.cbegin();
+  for (const SarpUpdateRecord &record : update) {
+    const Address &address = pool.Get(record.address);
+    while (changed_record != changed.cend() &&
+           pool.Get(changed_record->address) < address) {
+      result.push_back(*changed_record++);
+    }
+    if (changed_record != changed.cend() &&
+        changed_record->address == record.address) {
+      result.push_back(*changed_record++);
+    } else if (removed_address != removed.cend() &&
+               *removed_address == record.address) {
+      ++removed_address;
+    } else {
+      result.push_back(record);
+    }
+  }
+  result.insert(result.end(), changed_record, changed.cend());
+  return result;
+}
+
+void SarpRouting::CreateUpdateMirror(const Parameters::Sarp &parameters,
+                                     AddressPool &pool) {
+  SarpUpdate update = table_.CreateUpdate(pool);
+  if (parameters.digest_exchange) {
+    if (parameters.digest_cost_quantum > 0) {
+      KeepCloseCosts(update_mirror_, update, parameters.digest_cost_quantum,
+                     pool);
+    }
+    const Digest digest = UpdateDigest(update, pool);
+    if (digest == mirror_digest_) {
+      return;
+    }
+    published_updates_.push_back({mirror_digest_, std::move(update_mirror_)});
+    if (published_updates_.size() > parameters.digest_history) {
+      published_updates_.pop_front();
+    }
+    mirror_digest_ = digest;
+  }
+  update_mirror_ = std::move(update);
+}
+
+void SarpRouting::RequestUpdate(Env &env, NodeID neighbor) {
+  if (!env.parameters.get_sarp_parameters().digest_exchange) {
+    Routing::RequestUpdate(env, neighbor);
+    return;
+  }
+  auto held = held_digests_.find(neighbor);
+  std::unique_ptr<Packet> packet = std::make_unique<SarpDigestRequestPacket>(
+      node_->get_address(), env.network->get_node(neighbor)->get_address(),
+      held != held_digests_.end() ? held->second : 0);
+  SendToNeighbor(env, neighbor, std::move(packet));
+}
+
+void SarpRouting::SendDigestUpdate(Env &env, Digest held_digest,
+                                   NodeID neighbor) {
+  Digest base_digest = 0;
+  SarpUpdate changed;
+  std::vector<AddressID> removed;
+  if (held_digest == mirror_digest_) {
+    base_digest = held_digest;
+  } else {
+    auto published = std::find_if(
+        published_updates_.cbegin(), published_updates_.cend(),
+        [held_digest](const PublishedUpdate &published) {
+          return published.digest == held_digest;
+        });
+    if (published != published_updates_.cend()) {
+      base_digest = held_digest;
+      DiffUpdates(published->update, update_mirror_, env.address_pool,
+                  changed, removed);
+    } else {
+      changed = update_mirror_;
+    }
+  }
+  std::unique_ptr<Packet> packet = std::make_unique<SarpDigestUpdatePacket>(
+      node_->get_address(), env.network->get_node(neighbor)->get_address(),
+      base_digest, mirror_digest_, std::move(changed), std::move(removed));
+  SendToNeighbor(env, neighbor, std::move(packet));
+}
+
+bool SarpRouting::ReceiveDigestUpdate(const SarpDigestUpdatePacket &packet,
+                                      NodeID from_node,
+                                      const AddressPool &pool) {
+  const SarpUpdate no_update;
+  const SarpUpdate *base = &no_update;
+  if (packet.get_base_digest() != 0) {
+    auto held = held_digests_.find(from_node);
+    if (held == held_digests_.end() ||
+        held->second != packet.get_base_digest()) {
+      held_digests_.erase(from_node);
+      return false;
+    }
+    // The latest update is in the current batch or else in the last one.
+    auto update = last_updates_.find(from_node);
+    if (update == last_updates_.end()) {
+      update = batch_updates_.find(from_node);
+      if (update == batch_updates_.end()) {
+        held_digests_.erase(from_node);
+        return false;
+      }
+    }
+    base = &update->second;
+  }
+  SarpUpdate update = ApplyChanges(*base, packet.get_changed(),
+                                   packet.get_removed(), pool);
+  last_updates_[from_node] = std::move(update);
+  held_digests_[from_node] = packet.get_digest();
+  return true;
 }
 
 }  // namespace simulation
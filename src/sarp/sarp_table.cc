@@ -4,178 +4,305 @@
 
 #include "sarp/sarp_table.h"
 
+#include <algorithm>
 #include <cassert>
 
+#include "structure/hash.h"
+
 namespace simulation {
 
-void SarpTable::AddRecord(const Address &address, const Cost &cost,
-                          Node *via_neighbor, Node const *reflexive_via_node) {
-  auto [matching_record, success] =
-      data_.insert({address, {cost, via_neighbor}});
-  if (!success) {
-    if (cost.PreferTo(matching_record->second.cost)) {
-      matching_record->second = {.cost = cost, .via_node = via_neighbor};
-    }
+// RETURNS: digest of the children of a node with the next child added, 0 only
+// if none of the children has records. Children are added in order.
+static Digest AddChildDigest(Digest children_digest, AddressComponent component,
+                             Digest child_digest) {
+  if (child_digest == 0) {
+    return children_digest;  // Pruned nodes do not matter.
   }
+  const Digest digest =
+      Mix64(children_digest + Mix64(child_digest + component));
+  return digest != 0 ? digest : 1;
 }
 
-void SarpTable::Generalize(Node const *reflexive_via_node) {
-  for (auto it = data_.begin(); it != data_.end(); ++it) {
-    if (it->first.size() == 1) {
-      GeneralizeRecursive(it, reflexive_via_node);
-    }
+// RETURNS: digest of the subtree of a node, 0 only if it has no records.
+static Digest NodeDigest(bool has_record, const Cost &cost,
+                         Digest children_digest) {
+  if (!has_record) {
+    return children_digest;
   }
+  const Digest digest = Mix64(CostDigest(cost) + children_digest);
+  return digest != 0 ? digest : 1;
 }
 
-void SarpTable::Compact(double compact_treshold,
-                        double min_standard_deviation) {
-  for (auto record = data_.begin(); record != data_.end(); /* no increment */) {
-    if (HasRedundantChildren(record, compact_treshold,
-                             min_standard_deviation)) {
-      record = RemoveSubtree(record);
-    } else {
-      ++record;
-    }
+template <std::size_t FANOUT>
+BasicSarpTable<FANOUT>::BasicSarpTable() {
+  AllocateNode(NONE, Address());
+}
+
+template <std::size_t FANOUT>
+std::pair<typename BasicSarpTable<FANOUT>::iterator, bool>
+BasicSarpTable<FANOUT>::Insert(const Address &address, const Cost &cost,
+                               NodeID via_node) {
+  Index index = ROOT;
+  for (AddressComponent component : address) {
+    index = GetChild(index, component);
+  }
+  TrieNode &node = nodes_[index];
+  if (node.has_record) {
+    return {{this, index}, false};
   }
+  node.has_record = true;
+  node.record.cost = cost;
+  node.record.via_node = via_node;
+  ++size_;
+  LinkVia(index);
+  InvalidateCaches(index);
+  return {{this, index}, true};
 }
 
-bool SarpTable::NeedUpdate(const SarpTable &new_table,
-                           double difference_treshold,
-                           double ratio_variance_treshold) const {
-  for (auto update_record = new_table.cbegin();
-       update_record != new_table.cend(); ++update_record) {
-    assert(ratio_variance_treshold > 0 && ratio_variance_treshold < 1);
-    auto matching_record = Find(update_record->first);
-    if (matching_record == this->cend()) {
-      return true;
-    } else {
-      auto &old_cost = matching_record->second.cost;
-      auto &new_cost = update_record->second.cost;
-      if (std::abs(Cost::ZScore(old_cost, new_cost)) > difference_treshold) {
-        return true;
-      }
-    }
+template <std::size_t FANOUT>
+typename BasicSarpTable<FANOUT>::iterator BasicSarpTable<FANOUT>::Erase(
+    iterator record) {
+  // The next record is not removed together with the erased one.
+  const Index next = NextRecord(record.index_);
+  ClearRecord(record.index_);
+  return {this, next};
+}
+
+template <std::size_t FANOUT>
+void BasicSarpTable<FANOUT>::EraseVia(NodeID via_node) {
+  auto head = via_heads_.find(via_node);
+  if (head == via_heads_.end()) {
+    return;
+  }
+  for (Index index = head->second; index != NONE;) {
+    const Index next = nodes_[index].via_next;
+    ClearRecord(index);
+    index = next;
   }
-  return false;
 }
 
-SarpUpdate SarpTable::CreateUpdate() const {
-  SarpUpdate result;
-  for (const auto &[address, cost_with_neighbor] : data_) {
-    (void)result.emplace(address, cost_with_neighbor.cost);
+template <std::size_t FANOUT>
+bool BasicSarpTable<FANOUT>::Assign(const Address &address, const Cost &cost,
+                                    NodeID via_node) {
+  auto [record, inserted] = Insert(address, cost, via_node);
+  if (inserted) {
+    return true;
   }
-  return result;
+  if (record->cost == cost && record->via_node == via_node) {
+    return false;
+  }
+  record->cost = cost;
+  InvalidateCaches(record.index_);
+  SetViaNode(record.index_, via_node);
+  return true;
 }
 
-std::vector<SarpTable::SarpTable::iterator> SarpTable::GetDirectChildren(
-    iterator parent) {
-  assert(parent->first.size() > 0);
-  auto lower_bound = parent;
-  Address upper_address_bound = parent->first;
-  upper_address_bound.back() += 1;  // Increase the last address component.
-  auto upper_bound = data_.upper_bound(upper_address_bound);
-  // Now search for records with child address length in the lower - upper bound
-  // range.
-  auto direct_child_address_size = parent->first.size() + 1;
-  std::vector<iterator> children;
-  for (auto possible_child = lower_bound; possible_child != upper_bound;
-       ++possible_child) {
-    if (possible_child->first.size() == direct_child_address_size) {
-      children.push_back(possible_child);
+template <std::size_t FANOUT>
+void BasicSarpTable<FANOUT>::AddRecord(const Address &address,
+                                       const Cost &cost, NodeID via_neighbor,
+                                       NodeID reflexive_via_node) {
+  auto [matching_record, success] = Insert(address, cost, via_neighbor);
+  if (!success) {
+    if (cost.PreferTo(matching_record->cost)) {
+      matching_record->cost = cost;
+      InvalidateCaches(matching_record.index_);
+      SetViaNode(matching_record.index_, via_neighbor);
     }
   }
-  return children;
 }
 
-bool SarpTable::HasRedundantChildren(iterator record, double compact_treshold,
+template <std::size_t FANOUT>
+void BasicSarpTable<FANOUT>::Generalize(NodeID reflexive_via_node) {
+  GeneralizeBottomUp(reflexive_via_node, false, 0, 0);
+}
+
+template <std::size_t FANOUT>
+void BasicSarpTable<FANOUT>::Compact(double compact_treshold,
                                      double min_standard_deviation) {
-  assert(record != data_.end());
-  auto sd = record->second.cost.StandardDeviation();
-  if (sd < min_standard_deviation) {
-    return false;
+  for (Index index = FirstRecord(); index != NONE; index = NextRecord(index)) {
+    if (HasRedundantChildren(index, compact_treshold, min_standard_deviation)) {
+      FreeDescendants(index);
+    }
   }
-  return std::abs(Cost::ZScore(record->second.cost, 0)) > compact_treshold;
 }
 
-SarpTable::iterator SarpTable::RemoveSubtree(iterator record) {
-  auto lower_bound = std::next(record);
-  auto subtree_upper_address = record->first;
-  subtree_upper_address.back() += 1;
-  auto upper_bound = data_.lower_bound(subtree_upper_address);
-  return data_.erase(lower_bound, upper_bound);
+template <std::size_t FANOUT>
+void BasicSarpTable<FANOUT>::GeneralizeAndCompact(
+    NodeID reflexive_via_node, double compact_treshold,
+    double min_standard_deviation) {
+  GeneralizeBottomUp(reflexive_via_node, true, compact_treshold,
+                     min_standard_deviation);
 }
 
-Node *SarpTable::GetMostFrequentNeighbor(const std::vector<iterator> &children,
-                                         Node const *reflexive_via_node) {
-  std::map<Node *, int> counts;
-  if (children.size() == 1) {
-    return (*children.begin())->second.via_node;
-  }
-  for (const auto child : children) {
-    // Don't propagate reflexive node
-    if (child->second.via_node != reflexive_via_node) {
-      ++counts[child->second.via_node];
+template <std::size_t FANOUT>
+bool BasicSarpTable<FANOUT>::NeedUpdate(const BasicSarpTable &new_table,
+                                        double difference_treshold,
+                                        double ratio_variance_treshold) const {
+  assert(ratio_variance_treshold > 0 && ratio_variance_treshold < 1);
+  return NeedUpdateSubtree(ROOT, new_table, ROOT, difference_treshold);
+}
+
+template <std::size_t FANOUT>
+typename BasicSarpTable<FANOUT>::const_iterator
+BasicSarpTable<FANOUT>::FindBestMatch(const Address &address,
+                                      NodeID reflexive_via_node) const {
+  // Find the deepest node on the path of the address, every node other than
+  // the root has records in its subtree and all of them share the longest
+  // prefix with the address.
+  Index index = ROOT;
+  for (AddressComponent component : address) {
+    const Index child = FindChild(index, component);
+    if (child == NONE) {
+      break;
     }
+    index = child;
   }
-  auto PairLessThan = [](std::pair<Node *, int> p1, std::pair<Node *, int> p2) {
-    return p1.second < p2.second;
-  };
-  auto neighbor_maxcost_pair =
-      std::max_element(counts.cbegin(), counts.cend(), PairLessThan);
-  return neighbor_maxcost_pair->first;
+  if (IsRecord(index) && nodes_[index].record.address == address) {
+    return {this, index};
+  }
+  return {this, MatchInSubtree(index, reflexive_via_node)};
 }
 
-void SarpTable::GeneralizeRecursive(iterator record,
-                                    Node const *reflexive_via_node) {
-  // Recursive call to generalize all children first.
-  auto children = GetDirectChildren(record);
-  if (children.size() == 0) {
-    return;
+template <std::size_t FANOUT>
+ForwardingTable BasicSarpTable<FANOUT>::CompileForwardingTable(
+    NodeID reflexive_via_node) const {
+  std::vector<ForwardingTable::Entry> entries;
+  entries.reserve(nodes_.size() - free_nodes_.size());
+  // Nodes in preorder, i.e. sorted by their addresses.
+  for (Index index = ROOT; index != NONE;) {
+    const TrieNode &node = nodes_[index];
+    const Index match = MatchInSubtree(index, reflexive_via_node);
+    entries.push_back(
+        {node.record.address,
+         node.has_record ? node.record.via_node : ForwardingTable::NO_HOP,
+         match != NONE ? nodes_[match].record.via_node
+                       : ForwardingTable::NO_HOP});
+    const Index child = FirstChild(index);
+    index = (child != NONE) ? child : SkipSubtree(index);
   }
-  for (auto &child : children) {
-    GeneralizeRecursive(child, reflexive_via_node);
+  return ForwardingTable(entries);
+}
+
+template <std::size_t FANOUT>
+SarpUpdate BasicSarpTable<FANOUT>::CreateUpdate(AddressPool &pool) const {
+  SarpUpdate result;
+  result.reserve(size_);
+  for (auto record = cbegin(); record != cend(); ++record) {
+    result.push_back({pool.Intern(record->address), record->cost});
   }
-  // Get costs of all direct children.
-  std::vector<Cost> children_costs;
-  for (auto &child : children) {
-    children_costs.push_back(child->second.cost);
+  return result;
+}
+
+template <std::size_t FANOUT>
+std::vector<Address> BasicSarpTable<FANOUT>::Regeneralize(
+    const BasicSarpTable &merged, const std::vector<Address> &changed,
+    NodeID reflexive_via_node) {
+  std::vector<Address> dirty;
+  for (const Address &address : changed) {
+    dirty.push_back(address);
+    // Generalize reaches records below only if there is this one.
+    const Index merged_root = merged.FindNode(address);
+    if (merged_root != NONE &&
+        merged.IsRecord(merged_root) != IsRecord(FindNode(address))) {
+      for (Index index = merged_root; index != NONE;
+           index = merged.NextInSubtree(index, merged_root, false)) {
+        if (merged.nodes_[index].has_record) {
+          dirty.push_back(merged.nodes_[index].record.address);
+        }
+      }
+    }
+    for (Address prefix = address; prefix.size() > 1;) {
+      prefix.pop_back();
+      dirty.push_back(prefix);
+    }
   }
-  // Assign generalized cost.
-  Cost generalized_cost(children_costs);
-  record->second.cost = generalized_cost;
-  // Find a best via_node from the children the most frequent route which is not
-  // reflective route if possible.
-  record->second.via_node =
-      GetMostFrequentNeighbor(children, reflexive_via_node);
+  std::sort(dirty.begin(), dirty.end());
+  dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+  // Children follow their parents in order, so go backwards.
+  std::vector<Address> result;
+  for (auto address = dirty.crbegin(); address != dirty.crend(); ++address) {
+    if (RegeneralizeRecord(merged, *address, reflexive_via_node)) {
+      result.push_back(*address);
+    }
+  }
+  std::reverse(result.begin(), result.end());
+  return result;
 }
 
-std::pair<Address, bool> SarpTable::FindFreeSubtreeAddress(
+template <std::size_t FANOUT>
+bool BasicSarpTable<FANOUT>::Recompact(const BasicSarpTable &generalized,
+                                       const std::vector<Address> &changed,
+                                       double compact_treshold,
+                                       double min_standard_deviation,
+                                       double difference_treshold) {
+  bool need_update = false;
+  const Address *replaced = nullptr;
+  for (const Address &address : changed) {
+    if (replaced != nullptr &&
+        replaced->CommonPrefixLength(address) == replaced->size()) {
+      continue;  // The subtree has been copied already.
+    }
+    if (generalized.IsCompactedAway(address, compact_treshold,
+                                    min_standard_deviation)) {
+      continue;
+    }
+    const Index index = FindNode(address);
+    const Index generalized_index = generalized.FindNode(address);
+    const bool had_record = IsRecord(index);
+    const bool has_record = generalized.IsRecord(generalized_index);
+    const bool compacted =
+        had_record &&
+        HasRedundantChildren(index, compact_treshold, min_standard_deviation);
+    const bool compacts =
+        has_record &&
+        generalized.HasRedundantChildren(generalized_index, compact_treshold,
+                                         min_standard_deviation);
+    if (had_record != has_record || compacted != compacts) {
+      need_update |=
+          ReplaceSubtree(generalized, address, compact_treshold,
+                         min_standard_deviation, difference_treshold);
+      replaced = &address;
+    } else if (has_record) {
+      // Records below are the same, only this one has changed.
+      const Record &record = generalized.nodes_[generalized_index].record;
+      need_update |= CostNeedsUpdate(nodes_[index].record.cost, record.cost,
+                                     difference_treshold);
+      Assign(address, record.cost, record.via_node);
+    }
+  }
+  return need_update;
+}
+
+template <std::size_t FANOUT>
+std::pair<Address, bool> BasicSarpTable<FANOUT>::FindFreeSubtreeAddress(
     const_iterator root, range<AddressComponent> component_range) const {
   assert(root != cend());
-  auto subtree_upper_address = root->first;
-  subtree_upper_address.back() += 1;
-  auto upper_bound = data_.lower_bound(subtree_upper_address);
+  const const_iterator upper_bound(this, NextRecordAfterSubtree(root.index_));
   for (auto i = root; std::next(i) != upper_bound; ++i) {
-    if (std::abs(static_cast<std::ptrdiff_t>(i->first.size()) -
-                 static_cast<std::ptrdiff_t>(std::next(i)->first.size())) > 1) {
-      Address free_address = i->first;
+    const Address &address = i->address;
+    const Address &next_address = std::next(i)->address;
+    // Addresses at full length are only changed in their last component.
+    if (std::abs(static_cast<std::ptrdiff_t>(address.size()) -
+                 static_cast<std::ptrdiff_t>(next_address.size())) > 1 &&
+        address.size() < Address::MAX_SIZE) {
+      Address free_address = address;
       free_address.push_back(component_range.first);
       return {free_address, true};
-    } else if (i->first.size() < std::next(i)->first.size()) {
-      if (std::next(i)->first.back() != component_range.first) {
-        Address free_address = std::next(i)->first;
+    } else if (address.size() < next_address.size()) {
+      if (next_address.back() != component_range.first) {
+        Address free_address = next_address;
         free_address.back() = component_range.first;
         return {free_address, true};
       }
-    } else if (i->first.size() == std::next(i)->first.size()) {
-      if (i->first.back() + 1 != std::next(i)->first.back()) {
-        Address free_address = i->first;
+    } else if (address.size() == next_address.size()) {
+      if (address.back() + 1 != next_address.back()) {
+        Address free_address = address;
         free_address.back() += 1;
         return {free_address, true};
       }
-    } else if (i->first.size() > std::next(i)->first.size()) {
-      if (i->first.back() != component_range.second) {
-        Address free_address = i->first;
+    } else if (address.size() > next_address.size()) {
+      if (address.back() != component_range.second) {
+        Address free_address = address;
         free_address.back() = component_range.second;
         return {free_address, true};
       }
@@ -186,4 +313,610 @@ std::pair<Address, bool> SarpTable::FindFreeSubtreeAddress(
   return {Address(), false};
 }
 
+template <std::size_t FANOUT>
+typename BasicSarpTable<FANOUT>::Index BasicSarpTable<FANOUT>::FindNode(
+    const Address &address) const {
+  Index index = ROOT;
+  for (AddressComponent component : address) {
+    index = FindChild(index, component);
+    if (index == NONE) {
+      return NONE;
+    }
+  }
+  return index;
+}
+
+template <std::size_t FANOUT>
+typename BasicSarpTable<FANOUT>::Index BasicSarpTable<FANOUT>::FindChild(
+    Index parent, AddressComponent component) const {
+  if (component < FANOUT) {
+    return nodes_[parent].children[component];
+  }
+  for (Index child = nodes_[parent].overflow_children; child != NONE;
+       child = nodes_[child].next_overflow) {
+    const AddressComponent current = nodes_[child].record.address.back();
+    if (current >= component) {
+      return current == component ? child : NONE;
+    }
+  }
+  return NONE;
+}
+
+template <std::size_t FANOUT>
+typename BasicSarpTable<FANOUT>::Index BasicSarpTable<FANOUT>::GetChild(
+    Index parent, AddressComponent component) {
+  Index child = FindChild(parent, component);
+  if (child != NONE) {
+    return child;
+  }
+  Address address = nodes_[parent].record.address;
+  address.push_back(component);
+  child = AllocateNode(parent, address);
+  InvalidateCaches(parent);
+  if (component < FANOUT) {
+    nodes_[parent].children[component] = child;
+    return child;
+  }
+  // Keep the list sorted by components.
+  Index *link = &nodes_[parent].overflow_children;
+  while (*link != NONE && nodes_[*link].record.address.back() < component) {
+    link = &nodes_[*link].next_overflow;
+  }
+  nodes_[child].next_overflow = *link;
+  *link = child;
+  return child;
+}
+
+template <std::size_t FANOUT>
+typename BasicSarpTable<FANOUT>::Index BasicSarpTable<FANOUT>::FirstChild(
+    Index index) const {
+  const TrieNode &node = nodes_[index];
+  for (Index child : node.children) {
+    if (child != NONE) {
+      return child;
+    }
+  }
+  return node.overflow_children;
+}
+
+template <std::size_t FANOUT>
+typename BasicSarpTable<FANOUT>::Index BasicSarpTable<FANOUT>::NextSibling(
+    Index index) const {
+  const TrieNode &node = nodes_[index];
+  if (node.parent == NONE) {
+    return NONE;
+  }
+  const AddressComponent component = node.record.address.back();
+  if (component >= FANOUT) {
+    return node.next_overflow;
+  }
+  const TrieNode &parent = nodes_[node.parent];
+  for (std::size_t i = component + 1; i < FANOUT; ++i) {
+    if (parent.children[i] != NONE) {
+      return parent.children[i];
+    }
+  }
+  return parent.overflow_children;
+}
+
+template <std::size_t FANOUT>
+typename BasicSarpTable<FANOUT>::Index BasicSarpTable<FANOUT>::SkipSubtree(
+    Index index) const {
+  for (; index != NONE; index = nodes_[index].parent) {
+    const Index sibling = NextSibling(index);
+    if (sibling != NONE) {
+      return sibling;
+    }
+  }
+  return NONE;
+}
+
+template <std::size_t FANOUT>
+typename BasicSarpTable<FANOUT>::Index BasicSarpTable<FANOUT>::NextRecord(
+    Index index) const {
+  do {
+    const Index child = FirstChild(index);
+    index = (child != NONE) ? child : SkipSubtree(index);
+  } while (index != NONE && !nodes_[index].has_record);
+  return index;
+}
+
+template <std::size_t FANOUT>
+typename BasicSarpTable<FANOUT>::Index
+BasicSarpTable<FANOUT>::NextRecordAfterSubtree(Index index) const {
+  index = SkipSubtree(index);
+  if (index != NONE && !nodes_[index].has_record) {
+    index = NextRecord(index);
+  }
+  return index;
+}
+
+template <std::size_t FANOUT>
+typename BasicSarpTable<FANOUT>::Index BasicSarpTable<FANOUT>::NextInSubtree(
+    Index index, Index root, bool skip_children) const {
+  if (!skip_children) {
+    const Index child = FirstChild(index);
+    if (child != NONE) {
+      return child;
+    }
+  }
+  for (; index != root; index = nodes_[index].parent) {
+    const Index sibling = NextSibling(index);
+    if (sibling != NONE) {
+      return sibling;
+    }
+  }
+  return NONE;
+}
+
+template <std::size_t FANOUT>
+typename BasicSarpTable<FANOUT>::Index BasicSarpTable<FANOUT>::AllocateNode(
+    Index parent, const Address &address) {
+  Index index;
+  if (free_nodes_.empty()) {
+    index = nodes_.size();
+    nodes_.emplace_back();
+  } else {
+    index = free_nodes_.back();
+    free_nodes_.pop_back();
+    nodes_[index] = TrieNode();
+  }
+  TrieNode &node = nodes_[index];
+  node.record.address = address;
+  node.parent = parent;
+  node.children.fill(NONE);
+  return index;
+}
+
+template <std::size_t FANOUT>
+void BasicSarpTable<FANOUT>::ClearRecord(Index index) {
+  assert(nodes_[index].has_record);
+  InvalidateCaches(index);
+  UnlinkVia(index);
+  nodes_[index].has_record = false;
+  --size_;
+  Prune(index);
+}
+
+template <std::size_t FANOUT>
+void BasicSarpTable<FANOUT>::Prune(Index index) {
+  while (index != ROOT && !nodes_[index].has_record &&
+         FirstChild(index) == NONE) {
+    TrieNode &node = nodes_[index];
+    TrieNode &parent = nodes_[node.parent];
+    const AddressComponent component = node.record.address.back();
+    if (component < FANOUT) {
+      parent.children[component] = NONE;
+    } else {
+      Index *link = &parent.overflow_children;
+      while (*link != index) {
+        link = &nodes_[*link].next_overflow;
+      }
+      *link = node.next_overflow;
+    }
+    free_nodes_.push_back(index);
+    index = node.parent;
+  }
+}
+
+template <std::size_t FANOUT>
+void BasicSarpTable<FANOUT>::FreeDescendants(Index index) {
+  InvalidateCaches(index);
+  std::vector<Index> stack;
+  for (Index child = FirstChild(index); child != NONE;
+       child = NextSibling(child)) {
+    stack.push_back(child);
+  }
+  while (!stack.empty()) {
+    const Index descendant = stack.back();
+    stack.pop_back();
+    for (Index child = FirstChild(descendant); child != NONE;
+         child = NextSibling(child)) {
+      stack.push_back(child);
+    }
+    if (nodes_[descendant].has_record) {
+      UnlinkVia(descendant);
+      --size_;
+    }
+    free_nodes_.push_back(descendant);
+  }
+  nodes_[index].children.fill(NONE);
+  nodes_[index].overflow_children = NONE;
+}
+
+template <std::size_t FANOUT>
+void BasicSarpTable<FANOUT>::EraseSubtree(Index index) {
+  FreeDescendants(index);
+  if (nodes_[index].has_record) {
+    ClearRecord(index);
+  } else {
+    Prune(index);
+  }
+}
+
+template <std::size_t FANOUT>
+void BasicSarpTable<FANOUT>::LinkVia(Index index) {
+  TrieNode &node = nodes_[index];
+  auto [head, inserted] = via_heads_.try_emplace(node.record.via_node, index);
+  if (!inserted) {
+    node.via_next = head->second;
+    nodes_[head->second].via_previous = index;
+    head->second = index;
+  }
+}
+
+template <std::size_t FANOUT>
+void BasicSarpTable<FANOUT>::UnlinkVia(Index index) {
+  TrieNode &node = nodes_[index];
+  if (node.via_previous != NONE) {
+    nodes_[node.via_previous].via_next = node.via_next;
+  } else if (node.via_next != NONE) {
+    via_heads_[node.record.via_node] = node.via_next;
+  } else {
+    via_heads_.erase(node.record.via_node);
+  }
+  if (node.via_next != NONE) {
+    nodes_[node.via_next].via_previous = node.via_previous;
+  }
+  node.via_previous = NONE;
+  node.via_next = NONE;
+}
+
+template <std::size_t FANOUT>
+bool BasicSarpTable<FANOUT>::HasRedundantChildren(
+    Index index, double compact_treshold,
+    double min_standard_deviation) const {
+  const Cost &cost = nodes_[index].record.cost;
+  auto sd = cost.StandardDeviation();
+  if (sd < min_standard_deviation) {
+    return false;
+  }
+  return std::abs(Cost::ZScore(cost, 0)) > compact_treshold;
+}
+
+template <std::size_t FANOUT>
+void BasicSarpTable<FANOUT>::ChildrenSummary::Add(const Record &record,
+                                                 NodeID reflexive_via_node) {
+  if (costs_.Count() == 0) {
+    first_via_node_ = record.via_node;
+  }
+  costs_.Add(record.cost);
+  // Don't propagate reflexive node
+  if (record.via_node == reflexive_via_node) {
+    return;
+  }
+  for (std::size_t i = 0; i < via_counts_size_; ++i) {
+    if (via_counts_[i].via_node == record.via_node) {
+      ++via_counts_[i].count;
+      return;
+    }
+  }
+  if (via_counts_size_ < FANOUT) {
+    via_counts_[via_counts_size_++] = {record.via_node, 1};
+  } else {
+    ++more_via_counts_[record.via_node];
+  }
+}
+
+template <std::size_t FANOUT>
+NodeID BasicSarpTable<FANOUT>::ChildrenSummary::GetViaNode(
+    NodeID reflexive_via_node) const {
+  if (costs_.Count() == 1) {
+    return first_via_node_;
+  }
+  // Children routed only through the reflexive node leave no other choice.
+  ViaCount best{reflexive_via_node, 0};
+  auto Consider = [&best](NodeID via_node, std::size_t count) {
+    if (count > best.count ||
+        (count == best.count && via_node < best.via_node)) {
+      best = {via_node, count};
+    }
+  };
+  for (std::size_t i = 0; i < via_counts_size_; ++i) {
+    Consider(via_counts_[i].via_node, via_counts_[i].count);
+  }
+  for (const auto &[via_node, count] : more_via_counts_) {
+    Consider(via_node, count);
+  }
+  return best.via_node;
+}
+
+template <std::size_t FANOUT>
+typename BasicSarpTable<FANOUT>::ChildrenSummary
+BasicSarpTable<FANOUT>::SummarizeChildren(Index index,
+                                          NodeID reflexive_via_node) const {
+  ChildrenSummary children;
+  for (Index child = FirstChild(index); child != NONE;
+       child = NextSibling(child)) {
+    if (nodes_[child].has_record) {
+      children.Add(nodes_[child].record, reflexive_via_node);
+    }
+  }
+  return children;
+}
+
+template <std::size_t FANOUT>
+void BasicSarpTable<FANOUT>::GeneralizeBottomUp(NodeID reflexive_via_node,
+                                                bool compact,
+                                                double compact_treshold,
+                                                double min_standard_deviation) {
+  // Nodes from the root to the current one indexed by their depth.
+  std::array<PathNode, Address::MAX_SIZE + 1> path;
+  path[0].index = ROOT;
+  path[0].generalizes = true;  // The root itself is never generalized.
+  path[0].children_digest = 0;
+  std::size_t path_size = 1;
+  Index index = FirstChild(ROOT);
+  while (path_size > 0) {
+    const std::size_t depth =
+        index != NONE ? nodes_[index].record.address.size() : 0;
+    // Finish nodes whose subtrees the traversal has left.
+    while (path_size > depth) {
+      PathNode &finished = path[--path_size];
+      TrieNode &node = nodes_[finished.index];
+      if (path_size > 0 && finished.generalizes &&
+          !finished.children.Empty()) {
+        node.record.cost = finished.children.GetCost();
+        InvalidateCaches(finished.index);
+        SetViaNode(finished.index,
+                   finished.children.GetViaNode(reflexive_via_node));
+      }
+      if (compact && node.has_record &&
+          HasRedundantChildren(finished.index, compact_treshold,
+                               min_standard_deviation)) {
+        FreeDescendants(finished.index);
+        finished.children_digest = 0;
+      }
+      if (path_size > 1 && finished.generalizes) {
+        path[path_size - 1].children.Add(node.record, reflexive_via_node);
+      }
+      // Compaction visits all nodes, so digests are folded in on the way.
+      if (compact) {
+        node.digest = NodeDigest(node.has_record, node.record.cost,
+                                 finished.children_digest);
+        node.digest_valid = true;
+        if (path_size > 0) {
+          Digest &parent_digest = path[path_size - 1].children_digest;
+          parent_digest = AddChildDigest(
+              parent_digest, node.record.address.back(), node.digest);
+        }
+      }
+    }
+    if (index == NONE) {
+      break;
+    }
+    assert(path_size == depth);
+    PathNode &current = path[path_size++];
+    current.index = index;
+    current.generalizes =
+        nodes_[index].has_record && path[depth - 1].generalizes;
+    current.children = ChildrenSummary();
+    current.children_digest = 0;
+    // Records below nodes without records are only compacted.
+    index = NextInSubtree(index, ROOT, !current.generalizes && !compact);
+  }
+}
+
+template <std::size_t FANOUT>
+bool BasicSarpTable<FANOUT>::IsGeneralized(Index index) const {
+  for (Index ancestor = nodes_[index].parent; ancestor != ROOT;
+       ancestor = nodes_[ancestor].parent) {
+    if (!nodes_[ancestor].has_record) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <std::size_t FANOUT>
+bool BasicSarpTable<FANOUT>::RegeneralizeRecord(const BasicSarpTable &merged,
+                                                const Address &address,
+                                                NodeID reflexive_via_node) {
+  const Index merged_index = merged.FindNode(address);
+  if (!merged.IsRecord(merged_index)) {
+    auto record = Find(address);
+    if (record == end()) {
+      return false;
+    }
+    Erase(record);
+    return true;
+  }
+  const Record &merged_record = merged.nodes_[merged_index].record;
+  const Index index = FindNode(address);
+  ChildrenSummary children;
+  if (index != NONE && merged.IsGeneralized(merged_index)) {
+    children = SummarizeChildren(index, reflexive_via_node);
+  }
+  if (children.Empty()) {
+    return Assign(address, merged_record.cost, merged_record.via_node);
+  }
+  return Assign(address, children.GetCost(),
+                children.GetViaNode(reflexive_via_node));
+}
+
+template <std::size_t FANOUT>
+bool BasicSarpTable<FANOUT>::IsCompactedAway(
+    const Address &address, double compact_treshold,
+    double min_standard_deviation) const {
+  Index index = ROOT;
+  for (AddressComponent component : address) {
+    if (nodes_[index].has_record &&
+        HasRedundantChildren(index, compact_treshold, min_standard_deviation)) {
+      return true;
+    }
+    index = FindChild(index, component);
+    if (index == NONE) {
+      return false;
+    }
+  }
+  return false;
+}
+
+template <std::size_t FANOUT>
+bool BasicSarpTable<FANOUT>::ReplaceSubtree(const BasicSarpTable &generalized,
+                                            const Address &address,
+                                            double compact_treshold,
+                                            double min_standard_deviation,
+                                            double difference_treshold) {
+  // Previous records of the subtree sorted by their addresses.
+  std::vector<Record> previous;
+  const Index root = FindNode(address);
+  if (root != NONE) {
+    for (Index index = root; index != NONE;
+         index = NextInSubtree(index, root, false)) {
+      if (nodes_[index].has_record) {
+        previous.push_back(nodes_[index].record);
+      }
+    }
+    EraseSubtree(root);
+  }
+  auto AddressLessThan = [](const Record &record, const Address &address) {
+    return record.address < address;
+  };
+  bool need_update = false;
+  const Index generalized_root = generalized.FindNode(address);
+  for (Index index = generalized_root; index != NONE;) {
+    const TrieNode &node = generalized.nodes_[index];
+    bool compacts = false;
+    if (node.has_record) {
+      const Record &record = node.record;
+      (void)Insert(record.address, record.cost, record.via_node);
+      auto old_record = std::lower_bound(previous.cbegin(), previous.cend(),
+                                         record.address, AddressLessThan);
+      if (old_record == previous.cend() ||
+          old_record->address != record.address ||
+          CostNeedsUpdate(old_record->cost, record.cost, difference_treshold)) {
+        need_update = true;
+      }
+      compacts = generalized.HasRedundantChildren(index, compact_treshold,
+                                                  min_standard_deviation);
+    }
+    index = generalized.NextInSubtree(index, generalized_root, compacts);
+  }
+  return need_update;
+}
+
+template <std::size_t FANOUT>
+void BasicSarpTable<FANOUT>::SetViaNode(Index index, NodeID via_node) {
+  if (nodes_[index].record.via_node == via_node) {
+    return;
+  }
+  UnlinkVia(index);
+  nodes_[index].record.via_node = via_node;
+  LinkVia(index);
+  InvalidateCaches(index);
+}
+
+template <std::size_t FANOUT>
+typename BasicSarpTable<FANOUT>::Index BasicSarpTable<FANOUT>::MatchInSubtree(
+    Index index, NodeID reflexive_via_node) const {
+  const Index first = IsRecord(index) ? index : NextRecord(index);
+  if (first == NONE) {
+    return NONE;
+  }
+  if (best_reflexive_via_node_ != reflexive_via_node) {
+    for (const TrieNode &node : nodes_) {
+      node.best_valid = false;
+    }
+    best_reflexive_via_node_ = reflexive_via_node;
+  }
+  const Index best = BestRecord(index, reflexive_via_node);
+  if (best != NONE &&
+      nodes_[best].record.cost.PreferTo(nodes_[first].record.cost)) {
+    return best;
+  }
+  return first;
+}
+
+template <std::size_t FANOUT>
+typename BasicSarpTable<FANOUT>::Index BasicSarpTable<FANOUT>::BestRecord(
+    Index index, NodeID reflexive_via_node) const {
+  const TrieNode &node = nodes_[index];
+  if (node.best_valid) {
+    return node.best;
+  }
+  Index best = NONE;
+  if (node.has_record && node.record.via_node != reflexive_via_node) {
+    best = index;
+  }
+  // Children follow the node in order, so only strictly lower costs win.
+  for (Index child = FirstChild(index); child != NONE;
+       child = NextSibling(child)) {
+    const Index candidate = BestRecord(child, reflexive_via_node);
+    if (candidate != NONE &&
+        (best == NONE ||
+         nodes_[candidate].record.cost.PreferTo(nodes_[best].record.cost))) {
+      best = candidate;
+    }
+  }
+  node.best = best;
+  node.best_valid = true;
+  return best;
+}
+
+template <std::size_t FANOUT>
+void BasicSarpTable<FANOUT>::InvalidateCaches(Index index) {
+  nodes_[index].best_valid = false;
+  nodes_[index].digest_valid = false;
+  for (Index parent = nodes_[index].parent;
+       parent != NONE &&
+       (nodes_[parent].best_valid || nodes_[parent].digest_valid);
+       parent = nodes_[parent].parent) {
+    nodes_[parent].best_valid = false;
+    nodes_[parent].digest_valid = false;
+  }
+}
+
+template <std::size_t FANOUT>
+Digest BasicSarpTable<FANOUT>::SubtreeDigest(Index index) const {
+  const TrieNode &node = nodes_[index];
+  if (node.digest_valid) {
+    return node.digest;
+  }
+  Digest children_digest = 0;
+  for (Index child = FirstChild(index); child != NONE;
+       child = NextSibling(child)) {
+    children_digest =
+        AddChildDigest(children_digest, nodes_[child].record.address.back(),
+                       SubtreeDigest(child));
+  }
+  const Digest digest =
+      NodeDigest(node.has_record, node.record.cost, children_digest);
+  node.digest = digest;
+  node.digest_valid = true;
+  return digest;
+}
+
+template <std::size_t FANOUT>
+bool BasicSarpTable<FANOUT>::NeedUpdateSubtree(
+    Index index, const BasicSarpTable &new_table, Index new_index,
+    double difference_treshold) const {
+  if (index != NONE &&
+      SubtreeDigest(index) == new_table.SubtreeDigest(new_index)) {
+    return false;
+  }
+  const TrieNode &new_node = new_table.nodes_[new_index];
+  if (new_node.has_record) {
+    if (!IsRecord(index)) {
+      return true;
+    }
+    if (CostNeedsUpdate(nodes_[index].record.cost, new_node.record.cost,
+                        difference_treshold)) {
+      return true;
+    }
+  }
+  for (Index new_child = new_table.FirstChild(new_index); new_child != NONE;
+       new_child = new_table.NextSibling(new_child)) {
+    const AddressComponent component =
+        new_table.nodes_[new_child].record.address.back();
+    const Index child = index != NONE ? FindChild(index, component) : NONE;
+    if (NeedUpdateSubtree(child, new_table, new_child, difference_treshold)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template class BasicSarpTable<8>;
+
 }  // namespace simulation
@@ -0,0 +1,56 @@
+//
+// sarp_large_scale.cc
+//
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <string>
+
+#include "scenarios/basic.h"
+#include "structure/network.h"
+#include "structure/simulation.h"
+
+using namespace simulation;
+
+// Usage: sarp_large_scale [node_count [grid|uniform|poisson|clustered
+//                          [worker_threads]]]
+int main(int argc, char *argv[]) {
+  const std::size_t node_count =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+  const std::string layout_name = argc > 2 ? argv[2] : "uniform";
+  const unsigned worker_threads =
+      argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1;
+  Layout layout;
+  if (layout_name == "grid") {
+    layout = Layout::GRID;
+  } else if (layout_name == "uniform") {
+    layout = Layout::UNIFORM;
+  } else if (layout_name == "poisson") {
+    layout = Layout::POISSON_DISK;
+  } else if (layout_name == "clustered") {
+    layout = Layout::CLUSTERED;
+  } else {
+    std::cerr << "Unknown layout " << layout_name << '\n';
+    return 1;
+  }
+
+#ifdef CSV
+  std::cout << "run" << ',';
+  Parameters::PrintCsvHeader(std::cout);
+  Parameters::PrintSarpCsvHeader(std::cout);
+  Statistics::PrintCsvHeader(std::cout);
+#endif
+  for (int run = 0; run < 1; ++run) {
+    auto [sp, network, event_generators] =
+        LargeScale(RoutingType::SARP, node_count, layout, run + 1,
+                   worker_threads);
+
+#ifdef CSV
+    std::cout << run << ',';
+#endif
+    unsigned seed = std::time(nullptr);
+    Simulation::Run(seed, std::move(sp), *network, event_generators);
+  }
+  return 0;
+}
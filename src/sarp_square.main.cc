@@ -17,6 +17,7 @@ int main() {
 #ifdef CSV
   std::cout << "run" << ',';
   Parameters::PrintCsvHeader(std::cout);
+  Parameters::PrintSarpCsvHeader(std::cout);
   Statistics::PrintCsvHeader(std::cout);
 #endif
   for (int run = 0; run < 1; ++run) {
@@ -36,7 +37,7 @@ int main() {
 
 #ifdef DUMP
       for (const auto &node : network->get_nodes()) {
-        dynamic_cast<const SarpRouting &>(node->get_routing()).Dump(std::cerr);
+        dynamic_cast<const SarpRouting &>(node.get_routing()).Dump(std::cerr);
       }
 #endif
     }
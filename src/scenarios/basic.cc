@@ -4,6 +4,10 @@
 
 #include "scenarios/basic.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
 #include "network_generator/address_generator.h"
 #include "network_generator/position_generator.h"
 #include "sarp/octree.h"
@@ -90,12 +94,8 @@ LinearStaticOctreeAddresses(RoutingType routing, std::size_t node_count,
   Parameters::NodeGeneration node_generation;
   node_generation.node_count = node_count;
   node_generation.routing_type = routing;
-  std::vector<Position> positions;
-  for (std::size_t i = 0; i < node_count; ++i) {
-    positions.push_back(Position(general.connection_range * i, 0, 0));
-  }
-  node_generation.initial_positions =
-      std::make_unique<FinitePositionGenerator>(positions);
+  node_generation.initial_positions = std::make_unique<GridPositionGenerator>(
+      node_count, 1, 1, general.connection_range);
 
   Parameters::Traffic traffic;
   traffic.time_range = {400000, 450000};
@@ -147,15 +147,8 @@ SquareStaticOctreeAddresses(RoutingType routing, unsigned x, unsigned y,
   Parameters::NodeGeneration node_generation;
   node_generation.node_count = x * y;
   node_generation.routing_type = routing;
-  std::vector<Position> positions;
-  for (std::size_t i = 0; i < x; ++i) {
-    for (std::size_t j = 0; j < y; ++j) {
-      positions.push_back(Position(general.connection_range * i,
-                                   general.connection_range * j, 0));
-    }
-  }
-  node_generation.initial_positions =
-      std::make_unique<FinitePositionGenerator>(positions);
+  node_generation.initial_positions = std::make_unique<GridPositionGenerator>(
+      x, y, 1, general.connection_range);
 
   Parameters::Traffic traffic;
   traffic.time_range = {400000, 450000};
@@ -198,18 +191,8 @@ CubeStaticOctreeAddresses(RoutingType routing, unsigned x, unsigned y,
   Parameters::NodeGeneration node_generation;
   node_generation.node_count = x * y * z;
   node_generation.routing_type = routing;
-  std::vector<Position> positions;
-  for (std::size_t i = 0; i < x; ++i) {
-    for (std::size_t j = 0; j < y; ++j) {
-      for (std::size_t k = 0; k < z; ++k) {
-        positions.push_back(Position(general.connection_range * i,
-                                     general.connection_range * j,
-                                     general.connection_range * k));
-      }
-    }
-  }
-  node_generation.initial_positions =
-      std::make_unique<FinitePositionGenerator>(positions);
+  node_generation.initial_positions = std::make_unique<GridPositionGenerator>(
+      x, y, z, general.connection_range);
 
   Parameters::Traffic traffic;
   traffic.time_range = {400000, 450000};
@@ -454,4 +437,181 @@ MobileCube(RoutingType routing, Parameters::Sarp sarp_parameters) {
                          std::move(event_generators));
 }
 
+std::tuple<Parameters, std::unique_ptr<Network>,
+           std::vector<std::unique_ptr<EventGenerator>>>
+RandomMobileCube(RoutingType routing, Parameters::Sarp sarp_parameters) {
+  Parameters::General general;
+  general.duration = 500000;
+  general.ttl_limit = 16;
+  general.connection_range = 100;
+  general.routing_update_period = 10000;
+  general.neighbor_update_period = 10000;
+  general.boundaries = {Position(0, 0, 0), Position(400, 400, 400)};
+
+  Parameters::NodeGeneration node_generation;
+  node_generation.node_count = 120;
+  node_generation.routing_type = routing;
+  node_generation.initial_positions =
+      std::make_unique<RandomPositionGenerator>(general.boundaries);
+
+  Parameters::Traffic traffic;
+  traffic.time_range = {200000, 400000};
+  traffic.event_count = 3000;
+
+  Parameters::Movement movement;
+  movement.end = general.duration;
+  movement.step_period = 1000;
+  movement.speed_range = {1, 5};
+  movement.pause_range = {0, 5000};
+  movement.directions =
+      std::make_unique<RandomPositionGenerator>(general.boundaries);
+
+  Parameters sp;
+  sp.AddGeneral(general);
+  sp.AddNodeGeneration(std::move(node_generation));
+  sp.AddTraffic(traffic);
+  sp.AddMovement(std::move(movement));
+  if (routing == RoutingType::SARP) {
+    sp.AddSarp(sarp_parameters);
+  }
+
+  auto [network, event_generators] = Simulation::CreateScenario(sp);
+
+  event_generators.push_back(std::make_unique<OctreeAddressingEventGenerator>(
+      range<Time>{0, 1}, 3,  // start, end, period i.e. it happens only once.
+      *network));
+
+  return std::make_tuple(std::move(sp), std::move(network),
+                         std::move(event_generators));
+}
+
+std::tuple<Parameters, std::unique_ptr<Network>,
+           std::vector<std::unique_ptr<EventGenerator>>>
+LargeScale(RoutingType routing, std::size_t node_count, Layout layout,
+           uint64_t seed, unsigned worker_threads,
+           Parameters::Sarp sarp_parameters) {
+  Parameters::General general;
+  general.duration = 500000;
+  general.connection_range = 100;
+  general.routing_update_period = 10000;
+  general.neighbor_update_period = general.duration;  // i.e. 1 occurance
+  general.boundaries = UniformPositionGenerator::GetDensityBoundaries(
+      node_count, general.connection_range, 10);
+  general.worker_threads = worker_threads;
+  const unsigned side = general.boundaries.second.x;
+  general.ttl_limit = 1.1 * 3 * side / general.connection_range;
+
+  std::unique_ptr<ProceduralPositionGenerator> generator;
+  switch (layout) {
+    case Layout::GRID: {
+      // Extra positions of the last layers are not used.
+      const unsigned nodes_per_side = std::ceil(std::cbrt(node_count));
+      generator = std::make_unique<GridPositionGenerator>(
+          nodes_per_side, nodes_per_side, nodes_per_side,
+          side / nodes_per_side);
+    } break;
+    case Layout::UNIFORM:
+      generator = std::make_unique<UniformPositionGenerator>(
+          general.boundaries, node_count, seed);
+      break;
+    case Layout::POISSON_DISK: {
+      // About 28% of the candidates are accepted.
+      const uint32_t min_distance =
+          std::max<uint32_t>(1, side / std::cbrt(3.6 * node_count));
+      generator = std::make_unique<PoissonDiskPositionGenerator>(
+          general.boundaries, min_distance, seed);
+    } break;
+    case Layout::CLUSTERED: {
+      const std::size_t cluster_count =
+          std::max<std::size_t>(1, node_count / 1000);
+      generator = std::make_unique<ClusteredPositionGenerator>(
+          general.boundaries, node_count, cluster_count,
+          side / (2 * std::cbrt(cluster_count)), seed);
+    } break;
+  }
+  // Positions are generated in parallel once, clones of the node generator
+  // then share them.
+  ThreadPool thread_pool(worker_threads);
+  std::vector<Position> positions = GeneratePositions(*generator, thread_pool);
+  if (layout == Layout::POISSON_DISK) {
+    node_count = positions.size();
+  }
+  assert(positions.size() >= node_count);
+
+  Parameters::NodeGeneration node_generation;
+  node_generation.node_count = node_count;
+  node_generation.routing_type = routing;
+  node_generation.initial_positions =
+      std::make_unique<FinitePositionGenerator>(std::move(positions));
+
+  Parameters::Traffic traffic;
+  traffic.time_range = {400000, 450000};
+  traffic.event_count = 10000;
+
+  Parameters sp;
+  sp.AddGeneral(general);
+  sp.AddNodeGeneration(std::move(node_generation));
+  sp.AddTraffic(traffic);
+  if (routing == RoutingType::SARP) {
+    sp.AddSarp(sarp_parameters);
+  }
+
+  auto [network, event_generators] = Simulation::CreateScenario(sp);
+
+  // Add global initial addressing, happens only once at a start
+  event_generators.push_back(std::make_unique<OctreeAddressingEventGenerator>(
+      range<Time>{0, 1}, 3,  // start, end, period i.e. it happens only once.
+      *network));
+
+  return std::make_tuple(std::move(sp), std::move(network),
+                         std::move(event_generators));
+}
+
+std::tuple<Parameters, std::unique_ptr<Network>,
+           std::vector<std::unique_ptr<EventGenerator>>>
+ExternalTopology(RoutingType routing, std::unique_ptr<Topology> topology,
+                 const std::string &link_events_path,
+                 Parameters::Sarp sarp_parameters) {
+  assert(topology);
+  const std::size_t node_count = topology->get_node_count();
+
+  Parameters::General general;
+  general.duration = 500000;
+  general.ttl_limit = 64;
+  general.routing_update_period = 10000;
+  general.neighbor_update_period = general.duration;  // i.e. 1 occurance
+
+  Parameters::NodeGeneration node_generation;
+  node_generation.node_count = node_count;
+  node_generation.routing_type = routing;
+  node_generation.initial_addresses =
+      std::make_unique<SequentialAddressGenerator>();
+  // Positions do not matter, all nodes are placed to the origin.
+  node_generation.initial_positions =
+      std::make_unique<GridPositionGenerator>(node_count, 1, 1, 0);
+
+  Parameters::Traffic traffic;
+  traffic.time_range = {400000, 450000};
+  traffic.event_count = 10000;
+
+  Parameters sp;
+  sp.AddGeneral(general);
+  sp.AddNodeGeneration(std::move(node_generation));
+  sp.AddTraffic(traffic);
+  if (routing == RoutingType::SARP) {
+    sp.AddSarp(sarp_parameters);
+  }
+
+  auto [network, event_generators] = Simulation::CreateScenario(sp);
+  network->set_topology(std::move(topology));
+
+  if (!link_events_path.empty()) {
+    event_generators.push_back(
+        std::make_unique<LinkEventGenerator>(link_events_path, *network));
+  }
+
+  return std::make_tuple(std::move(sp), std::move(network),
+                         std::move(event_generators));
+}
+
 }  // namespace simulation
@@ -0,0 +1,20 @@
+//
+// address.cc
+//
+
+#include "structure/address.h"
+
+namespace simulation {
+
+std::ostream &operator<<(std::ostream &os, const Address &addr) {
+  os << '[';
+
+  char delim = 0;
+  for (const auto &addr_component : addr) {
+    os << delim << (unsigned)addr_component;
+    delim = '.';
+  }
+  return os << ']';
+}
+
+}  // namespace simulation
@@ -0,0 +1,30 @@
+//
+// address_pool.cc
+//
+
+#include "structure/address_pool.h"
+
+namespace simulation {
+
+AddressPool::AddressPool() {
+  ids_.emplace(Address(), ROOT);
+  addresses_.emplace_back();
+  parents_.push_back(ROOT);
+}
+
+AddressID AddressPool::Intern(const Address &address) {
+  if (auto it = ids_.find(address); it != ids_.end()) {
+    return it->second;
+  }
+  // Parents are interned first, recursion is bounded by Address::MAX_SIZE.
+  Address parent = address;
+  parent.pop_back();
+  const AddressID parent_id = Intern(parent);
+  const AddressID id = addresses_.size();
+  ids_.emplace(address, id);
+  addresses_.push_back(address);
+  parents_.push_back(parent_id);
+  return id;
+}
+
+}  // namespace simulation
@@ -4,7 +4,11 @@
 
 #include "structure/event.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
 
 #include "structure/simulation.h"
 
@@ -26,43 +30,45 @@ bool Event::operator<(const Event &other) const {
   return time_ < other.time_;
 }
 
-SendEvent::SendEvent(const Time time, TimeType time_type, Node &sender,
+SendEvent::SendEvent(const Time time, TimeType time_type, NodeID sender,
                      std::unique_ptr<Packet> packet)
     : Event(time, time_type), sender_(sender), packet_(std::move(packet)) {}
 
-SendEvent::SendEvent(const Time time, TimeType time_type, Node &sender,
-                     Node &destination, uint32_t size)
+SendEvent::SendEvent(const Time time, TimeType time_type, NodeID sender,
+                     NodeID destination, uint32_t size)
     : Event(time, time_type),
       sender_(sender),
-      destination_(&destination),
+      destination_(destination),
       size_(size) {}
 
 void SendEvent::Execute(Env &env) {
   env.stats.RegisterSendEvent();
+  Node &sender = *env.network->get_node(sender_);
   if (packet_) {
-    sender_.Send(env, std::move(packet_));
+    sender.Send(env, std::move(packet_));
   } else {
     // Create packet here because we want to have actual addresses of nodes.
     // These data packets are planned ahead of simulation.
-    auto packet = std::make_unique<Packet>(sender_.get_address(),
-                                           destination_->get_address(),
+    const Node &destination = *env.network->get_node(destination_);
+    auto packet = std::make_unique<Packet>(sender.get_address(),
+                                           destination.get_address(),
                                            PacketType::DATA, size_);
-    sender_.Send(env, std::move(packet));
+    sender.Send(env, std::move(packet));
   }
 }
 
 std::ostream &SendEvent::Print(std::ostream &os) const {
   if (packet_) {
-    return os << time_ << ":send:" << sender_ << " --" << *packet_ << "--> ["
-              << packet_->get_destination_address() << "]\n";
+    return os << time_ << ":send:<" << sender_ << "> --" << *packet_
+              << "--> [" << packet_->get_destination_address() << "]\n";
   } else {
-    return os << time_ << ":send:" << sender_ << " --{data_" << size_
-              << "}--> [" << destination_->get_address() << "]\n";
+    return os << time_ << ":send:<" << sender_ << "> --{data_" << size_
+              << "}--> <" << destination_ << ">\n";
   }
 }
 
-RecvEvent::RecvEvent(const Time time, TimeType time_type, Node &sender,
-                     Node &reciever, std::unique_ptr<Packet> packet)
+RecvEvent::RecvEvent(const Time time, TimeType time_type, NodeID sender,
+                     NodeID reciever, std::unique_ptr<Packet> packet)
     : Event(time, time_type),
       sender_(sender),
       reciever_(reciever),
@@ -75,16 +81,20 @@ void RecvEvent::Execute(Env &env) {
   assert(packet_ != nullptr);
   // WARNING: Here is a simplification, RecvEvent is only successful if both
   // sender and reciever are connected at the time of the recieve.
-  if (reciever_.IsConnectedTo(sender_,
-                              env.parameters.get_general().connection_range)) {
-    reciever_.Recv(env, std::move(packet_), &sender_);
+  // Lazily moving nodes have to be at their current positions.
+  env.network->get_mobility().UpdatePosition(env, sender_);
+  env.network->get_mobility().UpdatePosition(env, reciever_);
+  Node &reciever = *env.network->get_node(reciever_);
+  if (env.network->AreConnected(env.parameters, reciever,
+                                *env.network->get_node(sender_))) {
+    reciever.Recv(env, std::move(packet_), sender_);
   }
 }
 
 std::ostream &RecvEvent::Print(std::ostream &os) const {
   assert(packet_ != nullptr);
-  return os << time_ << ":recv:" << reciever_ << " --" << *packet_ << "--> ["
-            << packet_->get_destination_address() << "]\n";
+  return os << time_ << ":recv:<" << reciever_ << "> --" << *packet_
+            << "--> [" << packet_->get_destination_address() << "]\n";
 }
 
 TrafficEvent::TrafficEvent(Time time, TimeType time_type, Network &network,
@@ -98,8 +108,8 @@ void TrafficEvent::Execute(Env &env) {
     return;
   }
   uint32_t packet_size = 1;
-  auto send_event = std::make_unique<SendEvent>(0, TimeType::RELATIVE, *sender,
-                                                *receiver, packet_size);
+  auto send_event = std::make_unique<SendEvent>(0, TimeType::RELATIVE, from_,
+                                                to_, packet_size);
   env.simulation.ScheduleEvent(std::move(send_event));
 }
 
@@ -112,7 +122,7 @@ RandomTrafficEvent::RandomTrafficEvent(Time time, TimeType time_type,
     : Event(time, time_type), network_(network) {}
 
 void RandomTrafficEvent::Execute(Env &env) {
-  auto &nodes = network_.get_nodes();
+  const auto &nodes = network_.get_boot_order();
   if (nodes.size() < 2) {
     return;
   }
@@ -121,11 +131,9 @@ void RandomTrafficEvent::Execute(Env &env) {
   if (r1 == r2) {  // Avoid reflexive traffic.
     r2 = (r2 + 1) % nodes.size();
   }
-  Node &sender = *nodes[r1];
-  Node &receiver = *nodes[r2];
   uint32_t packet_size = 1;
-  auto send_event = std::make_unique<SendEvent>(0, TimeType::RELATIVE, sender,
-                                                receiver, packet_size);
+  auto send_event = std::make_unique<SendEvent>(
+      0, TimeType::RELATIVE, nodes[r1], nodes[r2], packet_size);
   env.simulation.ScheduleEvent(std::move(send_event));
 }
 
@@ -133,66 +141,176 @@ std::ostream &RandomTrafficEvent::Print(std::ostream &os) const {
   return os << time_ << ":random_traffic:\n";
 }
 
-MoveEvent::MoveEvent(Time time, TimeType time_type, Network &network,
-                     Node &node, std::unique_ptr<PositionGenerator> directions)
-    : Event(time, time_type),
+FlowEvent::FlowEvent(Network &network, Flow flow)
+    : Event(flow.time_range.first, TimeType::ABSOLUTE),
       network_(network),
-      node_(node),
-      directions_(std::move(directions)) {}
+      flow_(std::move(flow)) {}
 
-void MoveEvent::Execute(Env &env) {
-  assert(env.parameters.has_movement());
-  env.stats.RegisterMoveEvent();
-  if (env.simulation.get_current_time() >= env.parameters.get_movement().end) {
+// RETURNS: exponentially distributed time with given mean, at least 1.
+static Time GetExponentialTime(Time mean) {
+  const double uniform = std::rand() / (RAND_MAX + 1.0);
+  const double time = -static_cast<double>(mean) * std::log(1 - uniform);
+  return std::max<Time>(1, std::llround(time));
+}
+
+static bool HasPrefix(const Address &address, const Address &prefix) {
+  return address.CommonPrefixLength(prefix) == prefix.size();
+}
+
+void FlowEvent::UpdateCandidates(const Env &env) {
+  const Time now = env.simulation.get_current_time();
+  if (now < candidates_refresh_) {
     return;
   }
-  if (node_.has_mobility_plan() == false) {
-    if (AssignNewPlan(env.parameters) == false) {
-      return;  // There is no new plan i.e. exit.
+  const Time period = env.parameters.get_general().routing_update_period;
+  candidates_refresh_ = now + std::max<Time>(1, period);
+  for (auto [endpoint, candidates] :
+       {std::make_pair(&flow_.source, &source_candidates_),
+        std::make_pair(&flow_.destination, &destination_candidates_)}) {
+    if (endpoint->is_node) {
+      continue;
+    }
+    candidates->clear();
+    for (NodeID id : network_.get_boot_order()) {
+      const Node &node = *network_.get_node(id);
+      if (!node.get_addresses().empty() &&
+          HasPrefix(node.get_address(), endpoint->prefix)) {
+        candidates->push_back(id);
+      }
+    }
+  }
+}
+
+Node *FlowEvent::PickNode(const FlowEndpoint &endpoint,
+                          const std::vector<NodeID> &candidates,
+                          NodeID excluded) {
+  if (endpoint.is_node) {
+    return endpoint.node == excluded ? nullptr
+                                     : network_.get_node(endpoint.node);
+  }
+  if (candidates.empty()) {
+    return nullptr;
+  }
+  // Avoid reflexive traffic.
+  std::size_t i = std::rand() % candidates.size();
+  if (candidates[i] == excluded) {
+    if (candidates.size() == 1) {
+      return nullptr;
     }
+    i = (i + 1) % candidates.size();
   }
-  const Position old_position = node_.get_position();
-  const Time period = env.parameters.get_movement().step_period;
-  node_.Move(period);
-  network_.UpdateNodePosition(env.parameters, node_, old_position);
-  // Since the movement hasn't stopped plan next event.
-  env.simulation.ScheduleEvent(std::make_unique<MoveEvent>(
-      period, TimeType::RELATIVE, network_, node_, std::move(directions_)));
-}
-
-static double GetRandomDouble(double min, double max) {
-  assert(min < max);
-  double f = (double)std::rand() / RAND_MAX;
-  return min + f * (max - min);
-}
-
-bool MoveEvent::AssignNewPlan(const Parameters &parameters) {
-  if (directions_ == nullptr) {
-    directions_ = parameters.get_movement().directions->Clone();
-    if (directions_ == nullptr) {
-      return false;
+  return network_.get_node(candidates[i]);
+}
+
+Time FlowEvent::GetNextTime(Time now) {
+  switch (flow_.type) {
+    case Flow::Type::CBR:
+      return now + std::max<Time>(1, flow_.interval);
+    case Flow::Type::POISSON:
+      return now + GetExponentialTime(flow_.interval);
+    case Flow::Type::ON_OFF: {
+      const Time next = now + std::max<Time>(1, flow_.interval);
+      if (next < on_end_) {
+        return next;
+      }
+      // Wait for the next on period.
+      const Time on_start = on_end_ + GetExponentialTime(flow_.mean_off);
+      on_end_ = on_start + GetExponentialTime(flow_.mean_on);
+      return on_start;
     }
   }
-  const auto [destination, success] = directions_->Next();
-  if (!success) {
-    return false;
+  assert(false);
+  return now;
+}
+
+void FlowEvent::Execute(Env &env) {
+  const Time now = env.simulation.get_current_time();
+  if (flow_.type == Flow::Type::ON_OFF && on_end_ == 0) {
+    on_end_ = now + GetExponentialTime(flow_.mean_on);
+  }
+  UpdateCandidates(env);
+  Node *source = PickNode(flow_.source, source_candidates_,
+                          std::numeric_limits<NodeID>::max());
+  Node *destination =
+      source ? PickNode(flow_.destination, destination_candidates_,
+                        source->get_id())
+             : nullptr;
+  if (source && destination) {
+    env.stats.RegisterSendEvent();
+    source->Send(env, std::make_unique<Packet>(
+                          source->get_address(), destination->get_address(),
+                          PacketType::DATA, flow_.packet_size));
+    ++sent_;
+  }
+  if (flow_.packet_limit > 0 && sent_ >= flow_.packet_limit) {
+    return;
+  }
+  const Time next = GetNextTime(now);
+  if (next < flow_.time_range.second) {
+    Repeat(next);
+  }
+}
+
+std::ostream &FlowEvent::Print(std::ostream &os) const {
+  auto PrintEndpoint = [&os](const FlowEndpoint &endpoint) -> std::ostream & {
+    if (endpoint.is_node) {
+      return os << '<' << endpoint.node << '>';
+    }
+    return os << '[' << endpoint.prefix << ']';
+  };
+  os << time_ << ":flow:";
+  PrintEndpoint(flow_.source) << " -- ";
+  return PrintEndpoint(flow_.destination) << " #" << sent_ << '\n';
+}
+
+MoveEvent::MoveEvent(Time time, TimeType time_type, Network &network,
+                     NodeID node)
+    : Event(time, time_type), network_(network), node_(node) {}
+
+void MoveEvent::Execute(Env &env) {
+  if (network_.get_mobility().Move(env, node_)) {
+    // Since the movement hasn't stopped plan next step.
+    Repeat(time_ + env.parameters.get_movement().step_period);
   }
-  const auto &speed_range = parameters.get_movement().speed_range;
-  double speed = (speed_range.second <= speed_range.first)
-                     ? speed_range.second
-                     : GetRandomDouble(speed_range.first, speed_range.second);
-  const auto &pause_range = parameters.get_movement().pause_range;
-  Time pause = (pause_range.second <= pause_range.first)
-                   ? pause_range.second
-                   : GetRandomDouble(pause_range.first, pause_range.second);
-  node_.set_mobility_plan(
-      {.destination = destination, .speed = speed, .pause = pause});
-  return true;
 }
 
 std::ostream &MoveEvent::Print(std::ostream &os) const {
-  return os << time_ << ":move:" << node_ << " at " << node_.get_position()
-            << '\n';
+  return os << time_ << ":move:<" << node_ << ">\n";
+}
+
+MobilityStepEvent::MobilityStepEvent(Time time, TimeType time_type,
+                                     Network &network)
+    : Event(time, time_type), network_(network) {}
+
+void MobilityStepEvent::Execute(Env &env) {
+  network_.get_mobility().Step(env);
+}
+
+std::ostream &MobilityStepEvent::Print(std::ostream &os) const {
+  return os << time_ << ":mobility_step:\n";
+}
+
+LinkEvent::LinkEvent(Time time, TimeType time_type, Network &network,
+                     std::unique_ptr<LinkTrace> trace)
+    : Event(time, time_type), network_(network), trace_(std::move(trace)) {
+  assert(trace_ != nullptr);
+}
+
+void LinkEvent::Execute(Env &env) {
+  const Time now = env.simulation.get_current_time();
+  const LinkTrace::Change *change = trace_->Peek();
+  for (; change && change->time <= now; change = trace_->Peek()) {
+    network_.UpdateLink(env, change->node1, change->node2, change->connected,
+                        change->delivery_duration);
+    trace_->Pop();
+  }
+  if (change) {
+    Repeat(change->time);
+  }
+}
+
+std::ostream &LinkEvent::Print(std::ostream &os) const {
+  return os << time_ << ":link_changes:\n";
 }
 
 UpdateNeighborsEvent::UpdateNeighborsEvent(const Time time, TimeType time_type,
@@ -209,29 +327,29 @@ std::ostream &UpdateNeighborsEvent::Print(std::ostream &os) const {
 }
 
 UpdateRoutingEvent::UpdateRoutingEvent(const Time time, TimeType time_type,
-                                       Routing &routing)
-    : Event(time, time_type), routing_(routing) {}
+                                       NodeID node)
+    : Event(time, time_type), node_(node) {}
 
 void UpdateRoutingEvent::Execute(Env &env) {
   env.stats.RegisterUpdateRoutingEvent();
-  routing_.CheckPeriodicUpdate(env);
+  env.network->get_node(node_)->get_routing().CheckPeriodicUpdate(env);
 }
 
 std::ostream &UpdateRoutingEvent::Print(std::ostream &os) const {
-  return os << time_ << ":routing_update:" << routing_ << '\n';
+  return os << time_ << ":routing_update:<" << node_ << ">\n";
 }
 
 RequestUpdateEvent::RequestUpdateEvent(const Time time, TimeType time_type,
-                                       Node *node, Node *neighbor)
+                                       NodeID node, NodeID neighbor)
     : Event(time, time_type), node_(node), neighbor_(neighbor) {}
 
 void RequestUpdateEvent::Execute(Env &env) {
-  neighbor_->get_routing().SendUpdate(env, node_);
+  env.network->get_node(neighbor_)->get_routing().SendUpdate(env, node_);
 }
 
 std::ostream &RequestUpdateEvent::Print(std::ostream &os) const {
-  return os << time_ << ":request_update:" << *node_ << " <-- " << *neighbor_
-            << '\n';
+  return os << time_ << ":request_update:<" << node_ << "> <-- <" << neighbor_
+            << ">\n";
 }
 
 BootEvent::BootEvent(const Time time, TimeType time_type, Network &network,
@@ -243,15 +361,10 @@ BootEvent::BootEvent(const Time time, TimeType time_type, Network &network,
       directions_(std::move(directions)) {}
 
 void BootEvent::Execute(Env &env) {
-  auto &node = network_.AddNode(env.parameters, std::move(node_));
+  auto &node = network_.AddNode(env.parameters, std::move(*node_));
   node.get_routing().Init(env);
   if (env.parameters.has_movement()) {
-    // Schedule a first move event which does pick information form env on how
-    // to move the node.
-    // Leave one routing period for synchronization.
-    env.simulation.ScheduleEvent(std::make_unique<MoveEvent>(
-        env.parameters.get_general().routing_update_period, TimeType::RELATIVE,
-        network_, node, std::move(directions_)));
+    network_.get_mobility().AddNode(env, node.get_id(), std::move(directions_));
   }
 }
 
@@ -264,17 +377,18 @@ ReaddressEvent::ReaddressEvent(Time time, TimeType time_type, Network &network,
     : Event(time, time_type), network_(network), only_empty_(only_empty) {}
 
 void ReaddressEvent::Execute(Env &env) {
-  for (auto &node : network_.get_nodes()) {
-    if (only_empty_ && node->get_addresses().empty() == false) {
+  for (NodeID id : network_.get_boot_order()) {
+    Node &node = *network_.get_node(id);
+    if (only_empty_ && node.get_addresses().empty() == false) {
       continue;
     }
-    Address last_address = node->get_address();
-    const auto [new_address, success] = node->get_routing().SelectAddress(env);
+    Address last_address = node.get_address();
+    const auto [new_address, success] = node.get_routing().SelectAddress(env);
     if (!success) {
       continue;
     }
     // Keep last address and new one.
-    node->InitializeAddresses(
+    node.InitializeAddresses(
         Node::AddressContainerType({new_address, last_address}));
   }
 }
@@ -0,0 +1,56 @@
+//
+// forwarding_table.cc
+//
+
+#include "structure/forwarding_table.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace simulation {
+
+ForwardingTable::ForwardingTable(const std::vector<Entry> &entries) {
+  addresses_.reserve(entries.size());
+  hops_.reserve(entries.size());
+  // Entries with prefixes of the current address, the deepest on top.
+  std::vector<Index> prefixes;
+  for (const Entry &entry : entries) {
+    assert(addresses_.empty() || addresses_.back() < entry.address);
+    while (!prefixes.empty()) {
+      const Address &prefix = addresses_[prefixes.back()];
+      if (prefix.CommonPrefixLength(entry.address) == prefix.size()) {
+        break;
+      }
+      prefixes.pop_back();
+    }
+    const Index parent = prefixes.empty() ? NONE : prefixes.back();
+    prefixes.push_back(addresses_.size());
+    addresses_.push_back(entry.address);
+    hops_.push_back({parent, entry.exact_hop, entry.prefix_hop});
+  }
+}
+
+ForwardingTable::Match ForwardingTable::Lookup(const Address &address) const {
+  // The longest matching prefix is a prefix of the last entry not greater
+  // than the address or that entry itself.
+  auto upper_bound =
+      std::upper_bound(addresses_.cbegin(), addresses_.cend(), address);
+  if (upper_bound == addresses_.cbegin()) {
+    return {NO_HOP, false};
+  }
+  Index index = std::distance(addresses_.cbegin(), upper_bound) - 1;
+  const std::size_t lcp = addresses_[index].CommonPrefixLength(address);
+  while (index != NONE && addresses_[index].size() > lcp) {
+    index = hops_[index].parent;
+  }
+  if (index == NONE) {
+    return {NO_HOP, false};
+  }
+  const Hops &hops = hops_[index];
+  if (addresses_[index].size() == address.size() && hops.exact_hop != NO_HOP) {
+    return {hops.exact_hop, true};
+  }
+  return {hops.prefix_hop, false};
+}
+
+}  // namespace simulation
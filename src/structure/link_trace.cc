@@ -0,0 +1,63 @@
+//
+// link_trace.cc
+//
+
+#include "structure/link_trace.h"
+
+#include <sstream>
+#include <stdexcept>
+
+#include "structure/topology.h"
+
+namespace simulation {
+
+LinkTrace::LinkTrace(const std::string &path, std::size_t node_count)
+    : path_(path), is_(path), node_count_(node_count) {
+  if (!is_.is_open()) {
+    throw std::runtime_error("Can not open " + path);
+  }
+  Pop();
+}
+
+void LinkTrace::Pop() {
+  const Time last_time = next_.time;
+  has_next_ = false;
+  std::string line;
+  while (!has_next_ && std::getline(is_, line)) {
+    ++line_number_;
+    has_next_ = ParseLine(line);
+  }
+  if (has_next_ && next_.time < last_time) {
+    throw std::runtime_error(path_ + ':' + std::to_string(line_number_) +
+                             ": link changes are not ordered by time");
+  }
+}
+
+bool LinkTrace::ParseLine(const std::string &line) {
+  std::istringstream line_stream(line);
+  Change change;
+  char sign;
+  if (!(line_stream >> change.time >> sign) || (sign != '+' && sign != '-')) {
+    return false;
+  }
+  // Ids are read wider than NodeID so that too big ones are not truncated.
+  int64_t ids[2];
+  if (!(line_stream >> ids[0] >> ids[1]) || ids[0] < 0 || ids[1] < 0 ||
+      uint64_t(ids[0]) >= node_count_ || uint64_t(ids[1]) >= node_count_) {
+    throw std::runtime_error(path_ + ':' + std::to_string(line_number_) +
+                             ": expected two node ids less than " +
+                             std::to_string(node_count_));
+  }
+  if (ids[0] == ids[1]) {
+    return false;
+  }
+  change.node1 = ids[0];
+  change.node2 = ids[1];
+  change.connected = sign == '+';
+  change.delivery_duration = Topology::DEFAULT_DELIVERY_DURATION;
+  line_stream >> change.delivery_duration;
+  next_ = change;
+  return true;
+}
+
+}  // namespace simulation
@@ -0,0 +1,54 @@
+//
+// mapped_file.cc
+//
+
+#include "structure/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace simulation {
+
+static std::runtime_error FileError(const char *what, const std::string &path) {
+  return std::runtime_error(std::string(what) + ' ' + path + ": " +
+                            std::strerror(errno));
+}
+
+MappedFile::MappedFile(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw FileError("Can not open", path);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    auto error = FileError("Can not stat", path);
+    close(fd);
+    throw error;
+  }
+  // Empty files can not be mapped, their view is empty.
+  if (st.st_size > 0) {
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      auto error = FileError("Can not map", path);
+      close(fd);
+      throw error;
+    }
+    data_ = static_cast<const char *>(data);
+    size_ = st.st_size;
+  }
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data_) {
+    munmap(const_cast<char *>(data_), size_);
+  }
+}
+
+}  // namespace simulation
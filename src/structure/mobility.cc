@@ -0,0 +1,359 @@
+//
+// mobility.cc
+//
+
+#include "structure/mobility.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+#include "structure/event.h"
+#include "structure/network.h"
+#include "structure/simulation.h"
+
+namespace simulation {
+
+void Mobility::AddNode(Env &env, NodeID node,
+                       std::unique_ptr<PositionGenerator> directions) {
+  const Position position = network_.get_node(node)->get_position();
+  // Leave one routing period for synchronization.
+  const Time first_step = env.simulation.get_current_time() +
+                          env.parameters.get_general().routing_update_period;
+  if (IsLazy(env.parameters)) {
+    if (node >= segments_.size()) {
+      segments_.resize(node + 1);
+    }
+    Segment &segment = segments_[node];
+    segment.start = segment.arrival = segment.evaluated =
+        env.simulation.get_current_time();
+    segment.origin = segment.destination = position;
+    segment.directions = std::move(directions);
+    lazy_nodes_.push_back(node);
+    if (IsTrace(env.parameters)) {
+      if (trace_ == nullptr) {
+        trace_ = std::make_unique<MobilityTrace>(
+            env.parameters.get_movement().trace);
+        if (const auto *waypoint = trace_->Peek()) {
+          ScheduleStep(env, std::max(waypoint->time,
+                                     env.simulation.get_current_time()));
+        }
+      }
+      return;
+    }
+    auto [ends_it, success] = segment_ends_.try_emplace(first_step);
+    ends_it->second.push_back(node);
+    if (success) {
+      ScheduleStep(env, first_step);
+    }
+    return;
+  }
+  if (node >= plans_.size()) {
+    plans_.resize(node + 1);
+  }
+  plans_[node] = Plan();
+  plans_[node].directions = std::move(directions);
+  env.simulation.ScheduleEvent(std::make_unique<MoveEvent>(
+      first_step, TimeType::ABSOLUTE, network_, node));
+}
+
+bool Mobility::Move(Env &env, NodeID node) {
+  assert(env.parameters.has_movement() && !IsLazy(env.parameters));
+  env.stats.RegisterMoveEvents(1);
+  if (env.simulation.get_current_time() >= env.parameters.get_movement().end) {
+    return false;
+  }
+  Plan &plan = plans_[node];
+  if (!plan.active && !AssignNewPlan(env.parameters, plan)) {
+    return false;  // There is no new plan i.e. the node stops.
+  }
+  Node &n = *network_.get_node(node);
+  const Position old_position = n.get_position();
+  Position position = old_position;
+  if (Advance(plan, position, env.parameters.get_movement().step_period)) {
+    n.set_position(position);
+  }
+  network_.UpdateNodePositions(env.parameters, {node}, {old_position});
+  return true;
+}
+
+void Mobility::Step(Env &env) {
+  assert(env.parameters.has_movement() && IsLazy(env.parameters));
+  if (IsTrace(env.parameters)) {
+    StepTrace(env);
+    return;
+  }
+  StepLazy(env);
+}
+
+static double GetRandomDouble(double min, double max) {
+  assert(min < max);
+  double f = (double)std::rand() / RAND_MAX;
+  return min + f * (max - min);
+}
+
+bool Mobility::AssignNewPlan(const Parameters &parameters, Plan &plan) {
+  const auto &movement = parameters.get_movement();
+  if (plan.directions == nullptr) {
+    plan.directions = movement.directions->Clone();
+    if (plan.directions == nullptr) {
+      return false;
+    }
+  }
+  const auto [destination, success] = plan.directions->Next();
+  if (!success) {
+    return false;
+  }
+  const auto &speed_range = movement.speed_range;
+  const auto &pause_range = movement.pause_range;
+  plan.destination = destination;
+  plan.speed = (speed_range.second <= speed_range.first)
+                   ? speed_range.second
+                   : GetRandomDouble(speed_range.first, speed_range.second);
+  plan.pause = (pause_range.second <= pause_range.first)
+                   ? pause_range.second
+                   : GetRandomDouble(pause_range.first, pause_range.second);
+  plan.active = true;
+  return true;
+}
+
+static double NormalizeDouble(const double &d) {
+  if (d > 0 && d < 1) {
+    return 1;
+  } else if (d > -1 && d < 0) {
+    return -1;
+  }
+  return d;
+}
+
+bool Mobility::Advance(Plan &plan, Position &position, Time time_diff) {
+  if (position == plan.destination) {
+    if (plan.pause == 0) {
+      // We have reached the destination and waited for selected pause.
+      // Note that the plan is finished.
+      plan.active = false;
+    } else {
+      plan.pause -= time_diff;
+    }
+    return false;
+  }
+  // Move in given direction with given speed in time_diff.
+  double vector_x = plan.destination.x - position.x;
+  double vector_y = plan.destination.y - position.y;
+  double vector_z = plan.destination.z - position.z;
+  double distance = std::sqrt(vector_x * vector_x + vector_y * vector_y +
+                              vector_z * vector_z);
+  double seconds = time_diff / 1000;
+  double travel_distance = plan.speed * seconds;
+  if (NormalizeDouble(travel_distance) > distance) {
+    position = plan.destination;
+  } else {
+    double scale = travel_distance / distance;
+    position.x += NormalizeDouble(vector_x * scale);
+    position.y += NormalizeDouble(vector_y * scale);
+    position.z += NormalizeDouble(vector_z * scale);
+  }
+  return true;
+}
+
+void Mobility::ScheduleStep(Env &env, Time time) {
+  env.simulation.ScheduleEvent(
+      std::make_unique<MobilityStepEvent>(time, TimeType::ABSOLUTE, network_));
+}
+
+bool Mobility::IsLazy(const Parameters &parameters) {
+  return parameters.has_movement() &&
+         (parameters.get_movement().lazy_positions || IsTrace(parameters));
+}
+
+bool Mobility::IsTrace(const Parameters &parameters) {
+  return parameters.has_movement() && !parameters.get_movement().trace.empty();
+}
+
+void Mobility::UpdatePositions(Env &env) {
+  if (!IsLazy(env.parameters)) {
+    return;
+  }
+  std::vector<NodeID> moved_nodes;
+  std::vector<Position> old_positions;
+  for (NodeID node : lazy_nodes_) {
+    EvaluateNode(env, node, moved_nodes, old_positions);
+  }
+  network_.UpdateNodePositions(env.parameters, moved_nodes, old_positions);
+}
+
+void Mobility::UpdatePosition(Env &env, NodeID node) {
+  if (!IsLazy(env.parameters) || node >= segments_.size()) {
+    return;
+  }
+  std::vector<NodeID> moved_nodes;
+  std::vector<Position> old_positions;
+  EvaluateNode(env, node, moved_nodes, old_positions);
+  network_.UpdateNodePositions(env.parameters, moved_nodes, old_positions);
+}
+
+Position Mobility::EvaluateSegment(const Segment &segment, Time time) {
+  if (time >= segment.arrival) {
+    return segment.destination;
+  }
+  if (time <= segment.start) {
+    return segment.origin;
+  }
+  const double fraction = static_cast<double>(time - segment.start) /
+                          static_cast<double>(segment.arrival - segment.start);
+  auto Interpolate = [fraction](int from, int to) {
+    return from + static_cast<int>(std::lround((to - from) * fraction));
+  };
+  return Position(Interpolate(segment.origin.x, segment.destination.x),
+                  Interpolate(segment.origin.y, segment.destination.y),
+                  Interpolate(segment.origin.z, segment.destination.z));
+}
+
+void Mobility::EvaluateNode(Env &env, NodeID node, std::vector<NodeID> &nodes,
+                            std::vector<Position> &old_positions) {
+  Segment &segment = segments_[node];
+  if (segment.evaluated >= segment.arrival) {
+    return;  // Node already is at the destination.
+  }
+  // Nodes stop at the end of the movement.
+  segment.evaluated = std::min(env.simulation.get_current_time(),
+                               env.parameters.get_movement().end);
+  const Position position = EvaluateSegment(segment, segment.evaluated);
+  Node &n = *network_.get_node(node);
+  if (position == n.get_position()) {
+    return;
+  }
+  nodes.push_back(node);
+  old_positions.push_back(n.get_position());
+  n.set_position(position);
+}
+
+void Mobility::StepLazy(Env &env) {
+  const Time now = env.simulation.get_current_time();
+  auto ends_it = segment_ends_.find(now);
+  assert(ends_it != segment_ends_.end());
+  const std::vector<NodeID> nodes = std::move(ends_it->second);
+  segment_ends_.erase(ends_it);
+  env.stats.RegisterMoveEvents(nodes.size());
+  const auto &movement = env.parameters.get_movement();
+  if (now >= movement.end) {
+    return;
+  }
+  const auto &speed_range = movement.speed_range;
+  const auto &pause_range = movement.pause_range;
+  std::vector<NodeID> moved_nodes;
+  std::vector<Position> old_positions;
+  for (NodeID node : nodes) {
+    // Finish the last segment before starting a new one from its end.
+    EvaluateNode(env, node, moved_nodes, old_positions);
+    Segment &segment = segments_[node];
+    if (segment.directions == nullptr) {
+      segment.directions = movement.directions->Clone();
+      if (segment.directions == nullptr) {
+        continue;
+      }
+    }
+    const auto [destination, success] = segment.directions->Next();
+    if (!success) {
+      continue;  // There is no new plan i.e. the node stops.
+    }
+    segment.speed =
+        (speed_range.second <= speed_range.first)
+            ? speed_range.second
+            : GetRandomDouble(speed_range.first, speed_range.second);
+    Time pause = (pause_range.second <= pause_range.first)
+                     ? pause_range.second
+                     : GetRandomDouble(pause_range.first, pause_range.second);
+    segment.origin = segment.destination;
+    segment.destination = destination;
+    segment.start = segment.evaluated = now;
+    const double distance = Position::Distance(segment.origin, destination);
+    if (segment.speed <= 0 && distance > 0) {
+      // Node can not reach the destination so it stays where it is for good.
+      segment.destination = segment.origin;
+      segment.arrival = now;
+      continue;
+    }
+    segment.arrival =
+        now + ((distance > 0)
+                   ? static_cast<Time>(std::ceil(distance / segment.speed *
+                                                 1000))
+                   : 0);
+    // Each segment takes at least one time unit so that the node does not
+    // get new plans in a loop.
+    const Time end = std::max(segment.arrival + pause, now + 1);
+    auto [end_it, inserted] = segment_ends_.try_emplace(end);
+    end_it->second.push_back(node);
+    if (inserted) {
+      ScheduleStep(env, end);
+    }
+  }
+  network_.UpdateNodePositions(env.parameters, moved_nodes, old_positions);
+}
+
+void Mobility::StepTrace(Env &env) {
+  const Time now = env.simulation.get_current_time();
+  const Time end = env.parameters.get_movement().end;
+  std::size_t applied = 0;
+  const MobilityTrace::Waypoint *waypoint = trace_->Peek();
+  for (; waypoint && waypoint->time <= now; waypoint = trace_->Peek()) {
+    if (now < end) {
+      ApplyWaypoint(env, *waypoint);
+      ++applied;
+    }
+    trace_->Pop();
+  }
+  env.stats.RegisterMoveEvents(applied);
+  if (waypoint && waypoint->time < end) {
+    ScheduleStep(env, waypoint->time);
+  }
+}
+
+void Mobility::ApplyWaypoint(Env &env,
+                             const MobilityTrace::Waypoint &waypoint) {
+  const NodeID node = waypoint.node;
+  if (node >= segments_.size() || network_.get_node(node) == nullptr) {
+    return;  // The node has not booted yet.
+  }
+  const Time now = env.simulation.get_current_time();
+  std::vector<NodeID> moved_nodes;
+  std::vector<Position> old_positions;
+  // Finish the last segment before starting a new one from where it ended.
+  EvaluateNode(env, node, moved_nodes, old_positions);
+  network_.UpdateNodePositions(env.parameters, moved_nodes, old_positions);
+  Node &n = *network_.get_node(node);
+  Segment &segment = segments_[node];
+  segment.origin = n.get_position();
+  segment.start = segment.evaluated = now;
+  if (waypoint.coordinate != -1) {
+    // Jump to the position with the coordinate set.
+    int coordinates[3] = {segment.origin.x, segment.origin.y,
+                          segment.origin.z};
+    coordinates[waypoint.coordinate] = waypoint.value;
+    segment.origin = segment.destination =
+        Position(coordinates[0], coordinates[1], coordinates[2]);
+    segment.arrival = now;
+    if (!(segment.origin == n.get_position())) {
+      const std::vector<NodeID> jumped = {node};
+      const std::vector<Position> jumped_from = {n.get_position()};
+      n.set_position(segment.origin);
+      network_.UpdateNodePositions(env.parameters, jumped, jumped_from);
+    }
+    return;
+  }
+  segment.destination = waypoint.destination;
+  segment.speed = waypoint.speed;
+  const double distance =
+      Position::Distance(segment.origin, segment.destination);
+  if (segment.speed <= 0 || distance == 0) {
+    // Node can not move or is already there.
+    segment.destination = segment.origin;
+    segment.arrival = now;
+    return;
+  }
+  segment.arrival =
+      now + static_cast<Time>(std::ceil(distance / segment.speed * 1000));
+}
+
+}  // namespace simulation
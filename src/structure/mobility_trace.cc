@@ -0,0 +1,113 @@
+//
+// mobility_trace.cc
+//
+
+#include "structure/mobility_trace.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace simulation {
+
+// Parses number preceded by spaces or tabs and removes it from the text.
+// RETURNS: false if there is none.
+static bool ParseNumber(std::string_view &text, double *number) {
+  std::size_t begin = text.find_first_not_of(" \t");
+  if (begin == std::string_view::npos) {
+    return false;
+  }
+  const char *end = text.data() + text.size();
+  auto [ptr, error] = std::from_chars(text.data() + begin, end, *number);
+  if (error != std::errc() || !std::isfinite(*number)) {
+    return false;
+  }
+  text.remove_prefix(ptr - text.data());
+  return true;
+}
+
+// Removes text up to and including the token.
+// RETURNS: false if the token is missing.
+static bool SkipPast(std::string_view &text, std::string_view token) {
+  std::size_t i = text.find(token);
+  if (i == std::string_view::npos) {
+    return false;
+  }
+  text.remove_prefix(i + token.size());
+  return true;
+}
+
+// RETURNS: nearest coordinate, the negative ones are clamped to 0.
+static int ToCoordinate(double meters) {
+  return std::lround(std::max(meters, 0.0));
+}
+
+MobilityTrace::MobilityTrace(const std::string &path)
+    : file_(path), remaining_(file_.get_view()) {
+  Pop();
+}
+
+void MobilityTrace::Pop() {
+  has_next_ = false;
+  while (!has_next_ && !remaining_.empty()) {
+    std::size_t line_end = remaining_.find('\n');
+    std::string_view line = remaining_.substr(0, line_end);
+    remaining_.remove_prefix(line_end == std::string_view::npos
+                                 ? remaining_.size()
+                                 : line_end + 1);
+    has_next_ = ParseLine(line);
+  }
+}
+
+bool MobilityTrace::ParseLine(std::string_view line) {
+  Waypoint waypoint;
+  double seconds = 0;
+  std::string_view rest = line;
+  if (SkipPast(rest, "$ns_ at")) {
+    if (!ParseNumber(rest, &seconds) || seconds < 0) {
+      return false;
+    }
+  }
+  double node;
+  if (!SkipPast(rest, "$node_(") || !ParseNumber(rest, &node) || node < 0 ||
+      !SkipPast(rest, ")")) {
+    return false;
+  }
+  waypoint.time = std::llround(seconds * 1000);
+  waypoint.node = node;
+  std::size_t command = rest.find_first_not_of(" \t");
+  if (command == std::string_view::npos) {
+    return false;
+  }
+  rest.remove_prefix(command);
+  if (rest.substr(0, 8) == "setdest ") {
+    rest.remove_prefix(8);
+    double values[4];
+    int count = 0;
+    while (count < 4 && ParseNumber(rest, &values[count])) {
+      ++count;
+    }
+    if (count < 3) {
+      return false;
+    }
+    waypoint.destination =
+        Position(ToCoordinate(values[0]), ToCoordinate(values[1]),
+                 count == 4 ? ToCoordinate(values[2]) : 0);
+    waypoint.speed = values[count - 1];
+  } else if (rest.substr(0, 4) == "set " && rest.size() >= 6 &&
+             rest.substr(5, 1) == "_" && rest[4] >= 'X' && rest[4] <= 'Z') {
+    waypoint.coordinate = rest[4] - 'X';
+    rest.remove_prefix(6);
+    double value;
+    if (!ParseNumber(rest, &value)) {
+      return false;
+    }
+    waypoint.value = ToCoordinate(value);
+  } else {
+    return false;
+  }
+  next_ = waypoint;
+  return true;
+}
+
+}  // namespace simulation
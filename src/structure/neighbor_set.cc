@@ -0,0 +1,57 @@
+//
+// neighbor_set.cc
+//
+
+#include "structure/neighbor_set.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace simulation {
+
+void NeighborSet::Difference(const NeighborSet &first,
+                             const NeighborSet &second,
+                             std::vector<NodeID> *result) {
+  auto it = second.begin();
+  for (const Link &link : first) {
+    while (it != second.end() && it->id < link.id) {
+      ++it;
+    }
+    if (it == second.end() || it->id != link.id) {
+      result->push_back(link.id);
+    }
+  }
+}
+
+NeighborSet::NeighborSet(NeighborSet &&other) { *this = std::move(other); }
+
+NeighborSet &NeighborSet::operator=(NeighborSet &&other) {
+  size_ = std::exchange(other.size_, 0);
+  inline_links_ = other.inline_links_;
+  heap_links_ = std::move(other.heap_links_);
+  other.heap_links_.clear();
+  return *this;
+}
+
+void NeighborSet::PushBack(const Link &link) {
+  assert(empty() || std::prev(end())->id < link.id);
+  if (size_ < INLINE_CAPACITY) {
+    inline_links_[size_++] = link;
+    return;
+  }
+  if (size_ == INLINE_CAPACITY) {
+    heap_links_.assign(inline_links_.cbegin(), inline_links_.cend());
+  }
+  heap_links_.push_back(link);
+  ++size_;
+}
+
+const NeighborSet::Link *NeighborSet::Find(NodeID id) const {
+  auto it = std::lower_bound(
+      begin(), end(), id,
+      [](const Link &link, NodeID id) { return link.id < id; });
+  return (it != end() && it->id == id) ? it : nullptr;
+}
+
+}  // namespace simulation
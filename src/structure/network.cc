@@ -5,114 +5,511 @@
 #include "structure/network.h"
 
 #include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cmath>
 #include <iostream>
+#include <mutex>
+#include <unordered_map>
 
 namespace simulation {
 
-Node &Network::AddNode(const Parameters &parameters,
-                       std::unique_ptr<Node> node) {
+Node &Network::AddNode(const Parameters &parameters, Node &&node) {
+  const NodeID id = node.get_id();
+  if (id >= slots_.size()) {
+    slots_.resize(id + 1, NO_SLOT);
+  }
+  assert(slots_[id] == NO_SLOT);
+  slots_[id] = nodes_.size();
+  boot_order_.push_back(id);
   nodes_.push_back(std::move(node));
-  PlaceNode(parameters, *nodes_.back());
-  return *nodes_.back();
+  if (!topology_) {
+    PlaceNode(parameters, nodes_.back());
+  }
+  return nodes_.back();
 }
 
-void Network::UpdateNodePosition(const Parameters &parameters, const Node &node,
-                                 const Position &old_position) {
-  // Check if update it is necessary.
-  const auto connection_range = parameters.get_general().connection_range;
-  PositionCube old_cube(old_position, connection_range);
-  PositionCube new_cube(node.get_position(), connection_range);
-  if (old_cube == new_cube) {
+void Network::UpdateNodePositions(const Parameters &parameters,
+                                  const std::vector<NodeID> &nodes,
+                                  const std::vector<Position> &old_positions) {
+  assert(nodes.size() == old_positions.size());
+  if (topology_) {
     return;
   }
-  // Remove it from last position.
-  auto pos_boundaries = parameters.get_general().boundaries;
-  CubeID old_cube_id = old_cube.GetID(pos_boundaries.first,
-                                      pos_boundaries.second, connection_range);
-  std::size_t items_removed = node_placement_[old_cube_id].erase(
-      const_cast<Node *>(&node));  // Effectively const.
-  assert(items_removed == 1);
-  // Set new position cube and add it to new place.
-  CubeID new_cube_id = new_cube.GetID(pos_boundaries.first,
-                                      pos_boundaries.second, connection_range);
-  // Node ptr is effectively const.
-  auto [it, success] =
-      node_placement_[new_cube_id].insert(const_cast<Node *>(&node));
-  assert(success);
+  const auto cell_side = GetCellSide(parameters);
+  const auto &pos_boundaries = parameters.get_general().boundaries;
+  std::vector<std::size_t> migrations;
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    const Node &node = *get_node(nodes[i]);
+    PositionCube old_cube(old_positions[i], cell_side);
+    PositionCube new_cube(node.get_position(), cell_side);
+    // If the node stays in the same cube just update its coordinates.
+    if (old_cube == new_cube) {
+      CubeID cube_id = old_cube.GetID(pos_boundaries.first,
+                                      pos_boundaries.second, cell_side);
+      node_placement_[cube_id].Update(node.get_id(), node.get_position());
+    } else {
+      migrations.push_back(i);
+    }
+  }
+  // Remove migrating nodes from their last cubes first and then add them to
+  // the new ones.
+  for (std::size_t i : migrations) {
+    PositionCube old_cube(old_positions[i], cell_side);
+    CubeID old_cube_id =
+        old_cube.GetID(pos_boundaries.first, pos_boundaries.second, cell_side);
+    node_placement_[old_cube_id].Erase(nodes[i]);
+  }
+  for (std::size_t i : migrations) {
+    const Node &node = *get_node(nodes[i]);
+    PositionCube new_cube(node.get_position(), cell_side);
+    CubeID new_cube_id =
+        new_cube.GetID(pos_boundaries.first, pos_boundaries.second, cell_side);
+    node_placement_[new_cube_id].Insert(node.get_id(), node.get_position());
+  }
+}
+
+void Network::UpdateNeighbors(Env &env) {
+  mobility_.UpdatePositions(env);
+  const Time reorder_period = env.parameters.get_general().reorder_period;
+  if (reorder_period > 0 &&
+      env.simulation.get_current_time() >= next_reorder_time_) {
+    ReorderNodes(env.parameters);
+    next_reorder_time_ = env.simulation.get_current_time() + reorder_period;
+  }
+  if (!topology_) {
+    UpdateStencil(env.parameters);
+  }
+  std::vector<NeighborSet> new_neighbors(nodes_.size());
+  auto FindRange = [this, &env, &new_neighbors](std::size_t begin,
+                                                std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      new_neighbors[i] = topology_
+                             ? FindTopologyNeighbors(nodes_[i].get_id())
+                             : FindNeighbors(env.parameters, nodes_[i]);
+    }
+  };
+  const unsigned thread_count = env.parameters.get_general().worker_threads;
+  if (env.parameters.get_general().half_stencil && !topology_) {
+    std::vector<std::vector<NodeID>> neighbor_ids(nodes_.size());
+    FindNeighborPairs(env.parameters, neighbor_ids);
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+      new_neighbors[i] = CreateNeighborSet(nodes_[i], neighbor_ids[i]);
+    }
+  } else if (thread_count > 1) {
+    GetThreadPool(thread_count).ParallelFor(nodes_.size(), FindRange);
+  } else {
+    FindRange(0, nodes_.size());
+  }
+  // Apply in boot order, this is the only part which modifies routing.
+  for (NodeID id : boot_order_) {
+    const uint32_t slot = slots_[id];
+    nodes_[slot].UpdateNeighbors(env, std::move(new_neighbors[slot]));
+  }
 }
 
-Node *Network::get_node(NodeID id) {
-  for (auto &node : nodes_) {
-    if (node->get_id() == id) {
-      return node.get();
+void Network::UpdateLink(Env &env, NodeID node1, NodeID node2,
+                         bool connected, Time delivery_duration) {
+  assert(topology_);
+  if (connected) {
+    topology_->AddLink(node1, node2, delivery_duration);
+  } else {
+    topology_->RemoveLink(node1, node2);
+  }
+  for (NodeID id : {node1, node2}) {
+    if (Node *node = get_node(id)) {
+      node->UpdateNeighbors(env, FindTopologyNeighbors(id));
     }
   }
-  return nullptr;
 }
 
-// Friend method of Node -> can update neighbors
-void Network::UpdateNeighbors(Env &env) {
-  const uint32_t neighbor_count = 27;
-  const int relative_neighbors[neighbor_count][3] = {
-      {-1, -1, -1}, {-1, -1, 0}, {-1, -1, 1}, {-1, 0, -1}, {-1, 0, 0},
-      {-1, 0, 1},   {-1, 1, -1}, {-1, 1, 0},  {-1, 1, 1},  {0, -1, -1},
-      {0, -1, 0},   {0, -1, 1},  {0, 0, -1},  {0, 0, 0},   {0, 0, 1},
-      {0, 1, -1},   {0, 1, 0},   {0, 1, 1},   {1, -1, -1}, {1, -1, 0},
-      {1, -1, 1},   {1, 0, -1},  {1, 0, 0},   {1, 0, 1},   {1, 1, -1},
-      {1, 1, 0},    {1, 1, 1}};
-  for (auto &node : nodes_) {
-    std::set<Node *> new_neighbors;
-    const PositionCube node_cube(node->get_position(),
-                                 env.parameters.get_general().connection_range);
-    for (uint32_t i = 0; i < neighbor_count; ++i) {
-      auto [neighbor_cube, success] =
-          node_cube.GetRelativeCube(relative_neighbors[i]);
+bool Network::AreConnected(const Parameters &parameters, const Node &node1,
+                           const Node &node2) const {
+  if (topology_) {
+    return node1.get_id() == node2.get_id() ||
+           topology_->FindLink(node1.get_id(), node2.get_id()) != nullptr;
+  }
+  return node1.IsConnectedTo(node2,
+                             parameters.get_general().connection_range);
+}
+
+NeighborSet Network::FindTopologyNeighbors(NodeID node) const {
+  // Like in range based search each node is its own neighbor.
+  const Node &self = *get_node(node);
+  const NeighborSet::Link self_link = {
+      .id = node, .delivery_duration = Node::DeliveryDuration(self, self)};
+  NeighborSet neighbors;
+  bool self_added = false;
+  for (const Topology::Link &link : topology_->get_links(node)) {
+    if (!self_added && link.id > node) {
+      neighbors.PushBack(self_link);
+      self_added = true;
+    }
+    if (get_node(link.id)) {
+      neighbors.PushBack(link);
+    }
+  }
+  if (!self_added) {
+    neighbors.PushBack(self_link);
+  }
+  return neighbors;
+}
+
+uint32_t Network::GetCellSide(const Parameters &parameters) {
+  const auto &general = parameters.get_general();
+  assert(general.cell_divisor > 0);
+  return std::max<uint32_t>(1, general.connection_range / general.cell_divisor);
+}
+
+// Integer points of two cubes which are offset cubes apart along an axis are
+// at least this far apart along that axis.
+static int64_t MinAxisGap(int offset, uint32_t cell_side) {
+  return (offset == 0) ? 0 : (std::abs(offset) - 1) * int64_t(cell_side) + 1;
+}
+
+void Network::UpdateStencil(const Parameters &parameters) {
+  const uint32_t cell_side = GetCellSide(parameters);
+  const uint32_t range = parameters.get_general().connection_range;
+  if (cell_side == stencil_cell_side_ && range == stencil_range_) {
+    return;
+  }
+  stencil_cell_side_ = cell_side;
+  stencil_range_ = range;
+  stencil_.clear();
+  const int64_t squared_limit = Position::RangeSquaredLimit(range);
+  int reach = 0;
+  while (MinAxisGap(reach + 1, cell_side) * MinAxisGap(reach + 1, cell_side) <
+         squared_limit) {
+    ++reach;
+  }
+  for (int x = -reach; x <= reach; ++x) {
+    for (int y = -reach; y <= reach; ++y) {
+      for (int z = -reach; z <= reach; ++z) {
+        int64_t gx = MinAxisGap(x, cell_side);
+        int64_t gy = MinAxisGap(y, cell_side);
+        int64_t gz = MinAxisGap(z, cell_side);
+        if (gx * gx + gy * gy + gz * gz >= squared_limit) {
+          continue;
+        }
+        if (x == 0 && y == 0 && z == 0) {
+          stencil_center_ = stencil_.size();
+        }
+        stencil_.push_back({x, y, z});
+      }
+    }
+  }
+}
+
+NeighborSet Network::CreateNeighborSet(
+    const Node &node, std::vector<NodeID> &neighbor_ids) const {
+  // Neighboring cubes may share an ID so remove duplicates.
+  std::sort(neighbor_ids.begin(), neighbor_ids.end());
+  neighbor_ids.erase(std::unique(neighbor_ids.begin(), neighbor_ids.end()),
+                     neighbor_ids.end());
+  NeighborSet neighbors;
+  for (NodeID id : neighbor_ids) {
+    Time duration = Node::DeliveryDuration(node, nodes_[slots_[id]]);
+    neighbors.PushBack({.id = id, .delivery_duration = duration});
+  }
+  return neighbors;
+}
+
+NeighborSet Network::FindNeighbors(const Parameters &parameters,
+                                   const Node &node) const {
+  const auto &general = parameters.get_general();
+  const int64_t squared_limit =
+      Position::RangeSquaredLimit(general.connection_range);
+  std::vector<NodeID> neighbors;
+  const PositionCube node_cube(node.get_position(), stencil_cell_side_);
+  for (const CellOffset &offset : stencil_) {
+    auto [neighbor_cube, success] = node_cube.GetRelativeCube(
+        offset.data(), general.boundaries.first, general.boundaries.second,
+        stencil_cell_side_);
+    if (!success) {
+      continue;
+    }
+    CubeID neighbor_cube_id =
+        neighbor_cube.GetID(general.boundaries.first, general.boundaries.second,
+                            stencil_cell_side_);
+    auto cell_it = node_placement_.find(neighbor_cube_id);
+    if (cell_it != node_placement_.end()) {
+      cell_it->second.CollectInRange(node.get_position(), squared_limit,
+                                     &neighbors);
+    }
+  }
+  return CreateNeighborSet(node, neighbors);
+}
+
+void Network::FindNeighborPairs(
+    const Parameters &parameters,
+    std::vector<std::vector<NodeID>> &neighbor_ids) const {
+  const auto &general = parameters.get_general();
+  const int64_t squared_limit =
+      Position::RangeSquaredLimit(general.connection_range);
+  auto AddPair = [this, &neighbor_ids](NodeID node1, NodeID node2) {
+    neighbor_ids[slots_[node1]].push_back(node2);
+    neighbor_ids[slots_[node2]].push_back(node1);
+  };
+  for (const auto &[cube_id, cell] : node_placement_) {
+    if (cell.empty()) {
+      continue;
+    }
+    const PositionCube cube(cell.get_position(0), stencil_cell_side_);
+    // Center cube first, it pairs its nodes with each other only once.
+    for (std::size_t i = stencil_center_; i < stencil_.size(); ++i) {
+      auto [neighbor_cube, success] = cube.GetRelativeCube(
+          stencil_[i].data(), general.boundaries.first,
+          general.boundaries.second, stencil_cell_side_);
       if (!success) {
         continue;
       }
-      CubeID neighbor_cube_id =
-          neighbor_cube.GetID(env.parameters.get_general().boundaries.first,
-                              env.parameters.get_general().boundaries.second,
-                              env.parameters.get_general().connection_range);
-      auto node_set_it = node_placement_.find(neighbor_cube_id);
-      if (node_set_it != node_placement_.end()) {
-        for (Node *neighbor : node_set_it->second) {
-          if (node->IsConnectedTo(
-                  *neighbor, env.parameters.get_general().connection_range)) {
-            new_neighbors.insert(neighbor);
-          }
+      CubeID neighbor_cube_id = neighbor_cube.GetID(
+          general.boundaries.first, general.boundaries.second,
+          stencil_cell_side_);
+      auto cell_it = node_placement_.find(neighbor_cube_id);
+      if (cell_it != node_placement_.end()) {
+        cell.ForEachPairInRange(cell_it->second, squared_limit, AddPair);
+      }
+    }
+  }
+}
+
+ThreadPool &Network::GetThreadPool(unsigned thread_count) {
+  if (thread_pool_ == nullptr ||
+      thread_pool_->get_thread_count() != thread_count) {
+    thread_pool_ = std::make_unique<ThreadPool>(thread_count);
+  }
+  return *thread_pool_;
+}
+
+// Offsets of a cube and its neighbors which follow it in lexicographic order,
+// i.e. each pair of neighboring cubes is visited once.
+static const int FORWARD_NEIGHBORS[14][3] = {
+    {0, 0, 0},  {0, 0, 1},  {0, 1, -1}, {0, 1, 0},  {0, 1, 1},
+    {1, -1, -1}, {1, -1, 0}, {1, -1, 1}, {1, 0, -1}, {1, 0, 0},
+    {1, 0, 1},  {1, 1, -1}, {1, 1, 0},  {1, 1, 1}};
+
+// Compares pairs of positions of first and second, for the same range each
+// unordered pair once.
+template <typename GetPosition, typename GetNode>
+static void UpdateClosestPair(std::size_t first_count, std::size_t second_count,
+                              bool same, GetPosition &&get_position,
+                              GetNode &&get_node, int64_t *distance_squared,
+                              NodeID *node1, NodeID *node2) {
+  for (std::size_t i = 0; i < first_count; ++i) {
+    const Position position = get_position(true, i);
+    for (std::size_t j = same ? i + 1 : 0; j < second_count; ++j) {
+      int64_t d = Position::DistanceSquared(position, get_position(false, j));
+      if (d < *distance_squared && get_node(true, i) != get_node(false, j)) {
+        *distance_squared = d;
+        *node1 = get_node(true, i);
+        *node2 = get_node(false, j);
+      }
+    }
+  }
+}
+
+std::pair<NodeID, NodeID> Network::FindClosestPair(
+    const Parameters &parameters) {
+  assert(nodes_.size() >= 2);
+  ClosestPair closest = FindClosestPlacedPair(parameters);
+  // Any pair closer than the cube side is in neighboring cubes so if the pair
+  // found is not, search again in cubes with the side of its distance. Without
+  // any pair found try twice as big cubes.
+  int64_t cell_side = GetCellSide(parameters);
+  while (closest.distance_squared > cell_side * cell_side) {
+    if (closest.distance_squared == std::numeric_limits<int64_t>::max()) {
+      cell_side *= 2;
+    } else {
+      cell_side = std::ceil(std::sqrt(closest.distance_squared));
+    }
+    closest = FindClosestPairInGrid(parameters, cell_side);
+  }
+  return {closest.node1, closest.node2};
+}
+
+Network::ClosestPair Network::FindClosestPlacedPair(
+    const Parameters &parameters) {
+  const auto &boundaries = parameters.get_general().boundaries;
+  const uint32_t cell_side = GetCellSide(parameters);
+  std::vector<const PositionCell *> cells;
+  for (const auto &[cube_id, cell] : node_placement_) {
+    if (!cell.empty()) {
+      cells.push_back(&cell);
+    }
+  }
+  ClosestPair closest;
+  std::mutex closest_mutex;
+  auto FindRange = [&](std::size_t begin, std::size_t end) {
+    ClosestPair local;
+    for (std::size_t c = begin; c < end; ++c) {
+      const PositionCell &cell = *cells[c];
+      const PositionCube cube(cell.get_position(0), cell_side);
+      for (const auto &offset : FORWARD_NEIGHBORS) {
+        auto [neighbor_cube, success] = cube.GetRelativeCube(
+            offset, boundaries.first, boundaries.second, cell_side);
+        if (!success) {
+          continue;
         }
+        auto cell_it = node_placement_.find(neighbor_cube.GetID(
+            boundaries.first, boundaries.second, cell_side));
+        if (cell_it == node_placement_.end()) {
+          continue;
+        }
+        const PositionCell &other = cell_it->second;
+        UpdateClosestPair(
+            cell.size(), other.size(), &other == &cell,
+            [&](bool first, std::size_t i) {
+              return first ? cell.get_position(i) : other.get_position(i);
+            },
+            [&](bool first, std::size_t i) {
+              return first ? cell.get_node(i) : other.get_node(i);
+            },
+            &local.distance_squared, &local.node1, &local.node2);
       }
     }
-    node->UpdateNeighbors(env, new_neighbors);
+    std::lock_guard<std::mutex> lock(closest_mutex);
+    if (local.distance_squared < closest.distance_squared) {
+      closest = local;
+    }
+  };
+  GetThreadPool(parameters.get_general().worker_threads)
+      .ParallelFor(cells.size(), FindRange);
+  return closest;
+}
+
+Network::ClosestPair Network::FindClosestPairInGrid(
+    const Parameters &parameters, int64_t cell_side) {
+  // Cubes are indexed relative to the lowest coordinates, 21 bits per axis.
+  Position min_pos = nodes_.front().get_position();
+  for (const Node &node : nodes_) {
+    min_pos.x = std::min(min_pos.x, node.get_position().x);
+    min_pos.y = std::min(min_pos.y, node.get_position().y);
+    min_pos.z = std::min(min_pos.z, node.get_position().z);
+  }
+  auto CubeKey = [](int64_t x, int64_t y, int64_t z) {
+    return uint64_t(x) | uint64_t(y) << 21 | uint64_t(z) << 42;
+  };
+  std::unordered_map<uint64_t, std::vector<uint32_t>> cubes;
+  std::vector<std::array<int64_t, 3>> cube_of_node(nodes_.size());
+  for (uint32_t slot = 0; slot < nodes_.size(); ++slot) {
+    const Position position = nodes_[slot].get_position();
+    auto &cube = cube_of_node[slot];
+    cube = {(position.x - min_pos.x) / cell_side,
+            (position.y - min_pos.y) / cell_side,
+            (position.z - min_pos.z) / cell_side};
+    cubes[CubeKey(cube[0], cube[1], cube[2])].push_back(slot);
+  }
+  std::vector<const std::vector<uint32_t> *> slots_by_cube;
+  for (const auto &[key, cube_slots] : cubes) {
+    slots_by_cube.push_back(&cube_slots);
   }
+  ClosestPair closest;
+  std::mutex closest_mutex;
+  auto FindRange = [&](std::size_t begin, std::size_t end) {
+    ClosestPair local;
+    for (std::size_t c = begin; c < end; ++c) {
+      const std::vector<uint32_t> &cube_slots = *slots_by_cube[c];
+      const auto &cube = cube_of_node[cube_slots.front()];
+      for (const auto &offset : FORWARD_NEIGHBORS) {
+        int64_t x = cube[0] + offset[0];
+        int64_t y = cube[1] + offset[1];
+        int64_t z = cube[2] + offset[2];
+        if (x < 0 || y < 0 || z < 0) {
+          continue;
+        }
+        auto cube_it = cubes.find(CubeKey(x, y, z));
+        if (cube_it == cubes.end()) {
+          continue;
+        }
+        const std::vector<uint32_t> &other_slots = cube_it->second;
+        auto Slot = [&](bool first, std::size_t i) {
+          return first ? cube_slots[i] : other_slots[i];
+        };
+        UpdateClosestPair(
+            cube_slots.size(), other_slots.size(),
+            &other_slots == &cube_slots,
+            [&](bool first, std::size_t i) {
+              return nodes_[Slot(first, i)].get_position();
+            },
+            [&](bool first, std::size_t i) {
+              return nodes_[Slot(first, i)].get_id();
+            },
+            &local.distance_squared, &local.node1, &local.node2);
+      }
+    }
+    std::lock_guard<std::mutex> lock(closest_mutex);
+    if (local.distance_squared < closest.distance_squared) {
+      closest = local;
+    }
+  };
+  GetThreadPool(parameters.get_general().worker_threads)
+      .ParallelFor(slots_by_cube.size(), FindRange);
+  return closest;
 }
 
 void Network::PlaceNode(const Parameters &parameters, Node &node) {
-  auto connection_range = parameters.get_general().connection_range;
-  PositionCube cube{node.get_position(), connection_range};
+  auto cell_side = GetCellSide(parameters);
+  PositionCube cube{node.get_position(), cell_side};
   auto min_pos = parameters.get_general().boundaries.first;
   auto max_pos = parameters.get_general().boundaries.second;
-  auto cube_id = cube.GetID(min_pos, max_pos, connection_range);
-  auto &cube_set = node_placement_[cube_id];
-  const auto [it, success] = cube_set.insert(&node);
-  assert(success);
+  auto cube_id = cube.GetID(min_pos, max_pos, cell_side);
+  node_placement_[cube_id].Insert(node.get_id(), node.get_position());
+}
+
+static uint64_t CubeMortonCode(const Position &position,
+                               const Position &min_pos, uint32_t cell_side) {
+  auto CellIndex = [cell_side](int coordinate, int min_coordinate) {
+    return uint64_t(std::max(coordinate - min_coordinate, 0) / cell_side);
+  };
+  return MortonCode(CellIndex(position.x, min_pos.x),
+                    CellIndex(position.y, min_pos.y),
+                    CellIndex(position.z, min_pos.z));
+}
+
+void Network::ReorderNodes(const Parameters &parameters) {
+  const uint32_t cell_side = GetCellSide(parameters);
+  const Position &min_pos = parameters.get_general().boundaries.first;
+  struct SortKey {
+    uint64_t code;
+    NodeID id;
+    bool operator<(const SortKey &other) const {
+      return (code != other.code) ? code < other.code : id < other.id;
+    }
+  };
+  std::vector<SortKey> keys;
+  keys.reserve(nodes_.size());
+  for (const Node &node : nodes_) {
+    keys.push_back(
+        {.code = CubeMortonCode(node.get_position(), min_pos, cell_side),
+         .id = node.get_id()});
+  }
+  std::sort(keys.begin(), keys.end());
+  NodeContainer reordered;
+  reordered.reserve(nodes_.size());
+  for (const SortKey &key : keys) {
+    reordered.push_back(std::move(nodes_[slots_[key.id]]));
+    slots_[key.id] = reordered.size() - 1;
+  }
+  nodes_ = std::move(reordered);
 }
 
 void Network::ExportToDot(std::ostream &os) const {
   // Mark this as strict graph to remove duplikecate edges.
   os << "strict graph G {\n";
   // Assign position to all nodes.
-  for (auto &node : nodes_) {
-    os << '\t' << node->get_address() << " [ " << node->get_position()
+  for (NodeID id : boot_order_) {
+    const Node &node = *get_node(id);
+    os << '\t' << node.get_address() << " [ " << node.get_position()
        << " ]\n";
   }
   // Print all the edges. Go through all neighbors.
-  for (auto &node : nodes_) {
-    for (Node *neighbor : node->get_neighbors()) {
-      if (node.get() != neighbor) {
-        os << '\t' << node->get_address() << " -- " << neighbor->get_address()
-           << '\n';
+  for (NodeID id : boot_order_) {
+    const Node &node = *get_node(id);
+    for (const auto &link : node.get_neighbors()) {
+      if (node.get_id() != link.id) {
+        os << '\t' << node.get_address() << " -- "
+           << get_node(link.id)->get_address() << '\n';
       }
     }
   }
@@ -28,23 +28,37 @@ std::ostream &operator<<(std::ostream &os, const Node &node) {
 Node &Node::operator=(Node &&node) {
   // In case of rvalue assignment unique id is just coppied.
   this->id_ = node.id_;
-  this->addresses_ = node.addresses_;
-  this->neighbors_ = node.neighbors_;
+  this->position_ = node.position_;
+  // Moved set keeps its elements so the iterator stays valid.
+  this->addresses_ = std::move(node.addresses_);
+  this->latest_address_ = node.latest_address_;
+  this->refresh_times_ = std::move(node.refresh_times_);
+  this->neighbors_ = std::move(node.neighbors_);
+  this->moved_ = node.moved_;
   this->routing_ = std::move(node.routing_);
+  if (this->routing_) {
+    this->routing_->node_ = this;
+  }
   return *this;
 }
 
 bool Node::IsConnectedTo(const Node &node, uint32_t connection_range) const {
-  uint32_t distance = Position::Distance(position_, node.position_);
-  return distance <= connection_range;
+  return Position::IsInRange(position_, node.position_, connection_range);
 }
 
-void Node::UpdateNeighbors(Env &env, std::set<Node *> new_neighbors) {
-  routing_->UpdateNeighbors(env, new_neighbors);
-  neighbors_ = new_neighbors;
+void Node::UpdateNeighbors(Env &env, NeighborSet new_neighbors) {
+  std::vector<NodeID> added;
+  std::vector<NodeID> removed;
+  NeighborSet::Difference(new_neighbors, neighbors_, &added);
+  NeighborSet::Difference(neighbors_, new_neighbors, &removed);
+  neighbors_ = std::move(new_neighbors);
+  moved_ = false;
+  if (!added.empty() || !removed.empty()) {
+    routing_->UpdateNeighbors(env, added, removed);
+  }
 }
 
-static Time DeliveryDuration(const Node &n1, const Node &n2) {
+Time Node::DeliveryDuration(const Node &n1, const Node &n2) {
   uint32_t distance = Position::Distance(n1.get_position(), n2.get_position());
   Time t = distance / 10;
   return (t < 1) ? 1 : t;
@@ -56,15 +70,31 @@ void Node::Send(Env &env, std::unique_ptr<Packet> packet) {
 
   Node *to_node = routing_->Route(env, *packet);
   if (to_node) {
-    if (!IsConnectedTo(*to_node,
-                       env.parameters.get_general().connection_range)) {
+    // Lazily moving nodes have to be at their current positions.
+    env.network->get_mobility().UpdatePosition(env, id_);
+    env.network->get_mobility().UpdatePosition(env, to_node->get_id());
+    if (!env.network->AreConnected(env.parameters, *this, *to_node)) {
       env.stats.RegisterRoutingResultNotNeighbor();
       return;
     }
-    Time delivery_duration = DeliveryDuration(*this, *to_node);
-    env.simulation.ScheduleEvent(
-        std::make_unique<RecvEvent>(delivery_duration, TimeType::RELATIVE,
-                                    *this, *to_node, std::move(packet)));
+    Time delivery_duration;
+    if (const Topology *topology = env.network->get_topology()) {
+      // Links of the topology have their own durations, a node is connected
+      // to itself without a link.
+      const NeighborSet::Link *link =
+          topology->FindLink(id_, to_node->get_id());
+      delivery_duration =
+          link ? link->delivery_duration : DeliveryDuration(*this, *to_node);
+    } else {
+      // Cached duration is valid as long as none of the nodes has moved.
+      const NeighborSet::Link *link = neighbors_.Find(to_node->get_id());
+      delivery_duration = (link && !moved_ && !to_node->moved_)
+                              ? link->delivery_duration
+                              : DeliveryDuration(*this, *to_node);
+    }
+    env.simulation.ScheduleEvent(std::make_unique<RecvEvent>(
+        delivery_duration, TimeType::RELATIVE, id_, to_node->get_id(),
+        std::move(packet)));
   } else {
     // Routing did not find a route for the packet so just report it.
     if (packet->IsRoutingUpdate()) {
@@ -75,7 +105,7 @@ void Node::Send(Env &env, std::unique_ptr<Packet> packet) {
   }
 }
 
-void Node::Recv(Env &env, std::unique_ptr<Packet> packet, Node *from_node) {
+void Node::Recv(Env &env, std::unique_ptr<Packet> packet, NodeID from_node) {
   assert(IsInitialized());
   if (packet->IsTTLExpired(env.parameters.get_general().ttl_limit)) {
     env.stats.RegisterTTLExpire();
@@ -87,15 +117,13 @@ void Node::Recv(Env &env, std::unique_ptr<Packet> packet, Node *from_node) {
     return;
   }
   // Check for match in destination_address on packet.
-  for (const auto &addr : addresses_) {
-    if (addr == packet->get_destination_address()) {
-      env.stats.RegisterDeliveredPacket();
-      return;
-    }
+  if (addresses_.contains(packet->get_destination_address())) {
+    env.stats.RegisterDeliveredPacket();
+    return;
   }
   env.stats.RegisterHop();
   env.simulation.ScheduleEvent(std::make_unique<SendEvent>(
-      1, TimeType::RELATIVE, *this, std::move(packet)));
+      1, TimeType::RELATIVE, id_, std::move(packet)));
 }
 
 void Node::AddAddress(Address addr) {
@@ -109,6 +137,37 @@ void Node::AddAddress(Address addr) {
   routing_->UpdateAddresses();
 }
 
+void Node::RefreshAddress(Address addr, Time time) {
+  assert(IsInitialized());
+  if (addr.empty()) {
+    return;
+  }
+  auto [it, inserted] = addresses_.insert(addr);
+  refresh_times_[std::move(addr)] = time;
+  if (inserted || it != latest_address_) {
+    latest_address_ = it;
+    routing_->UpdateAddresses();
+  }
+}
+
+std::size_t Node::ExpireAddresses(Env &env, Time time) {
+  assert(IsInitialized());
+  std::vector<Address> expired;
+  for (auto it = refresh_times_.begin(); it != refresh_times_.end();) {
+    if (it->second > time || it->first == *latest_address_) {
+      ++it;
+      continue;
+    }
+    auto entry = refresh_times_.extract(it++);
+    addresses_.erase(entry.key());
+    expired.push_back(std::move(entry.key()));
+  }
+  if (!expired.empty()) {
+    routing_->WithdrawAddresses(env, expired);
+  }
+  return expired.size();
+}
+
 void Node::InitializeAddresses(Node::AddressContainerType addresses) {
   assert(IsInitialized());
   // Remove empty addresses.
@@ -121,52 +180,8 @@ void Node::InitializeAddresses(Node::AddressContainerType addresses) {
   }
   addresses_ = addresses;
   latest_address_ = addresses_.begin();
+  refresh_times_.clear();  // Given addresses do not expire.
   routing_->UpdateAddresses();
 }
 
-static double NormalizeDouble(const double &d) {
-  if (d > 0 && d < 1) {
-    return 1;
-  } else if (d > -1 && d < 0) {
-    return -1;
-  }
-  return d;
-}
-
-void Node::Move(Time time_diff) {
-  if (!has_mobility_plan()) {
-    return;
-  }
-  auto &plan = mobility_.second;
-  if (position_ == plan.destination) {
-    if (plan.pause == 0) {
-      // We have reached the destination and waited for selected pause.
-      // Note that the plan is finished.
-      mobility_.first = false;
-    } else {
-      plan.pause -= time_diff;
-    }
-  } else {
-    // Move in given direction with given speed in time_diff.
-    double vector_x = plan.destination.x - position_.x;
-    double vector_y = plan.destination.y - position_.y;
-    double vector_z = plan.destination.z - position_.z;
-    double distance = std::sqrt(vector_x * vector_x + vector_y * vector_y +
-                                vector_z * vector_z);
-    double seconds = time_diff / 1000;
-    double travel_distance = plan.speed * seconds;
-    if (NormalizeDouble(travel_distance) > distance) {
-      position_ = plan.destination;
-    } else {
-      double scale = travel_distance / distance;
-      vector_x *= scale;
-      vector_y *= scale;
-      vector_z *= scale;
-      position_.x += NormalizeDouble(vector_x);
-      position_.y += NormalizeDouble(vector_y);
-      position_.z += NormalizeDouble(vector_z);
-    }
-  }
-}
-
 }  // namespace simulation
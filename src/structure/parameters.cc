@@ -47,7 +47,11 @@ std::ostream &operator<<(std::ostream &os, const Parameters::General &p) {
             << "\nconnection_range: " << p.connection_range
             << "\nrouting_update_period: " << p.neighbor_update_period
             << "\nneighbor_update_period: " << p.neighbor_update_period
-            << "\nboundaries: " << p.boundaries;
+            << "\nboundaries: " << p.boundaries
+            << "\nworker_threads: " << p.worker_threads
+            << "\ncell_divisor: " << p.cell_divisor
+            << "\nhalf_stencil: " << p.half_stencil
+            << "\nreorder_period: " << p.reorder_period;
   // clang-format on
 }
 
@@ -75,7 +79,8 @@ std::ostream &operator<<(std::ostream &os, const Parameters::Traffic &p) {
   // clang-format off
   return os << "Traffic parameters:"
             << "\ntraffic_time_range: " << p.time_range
-            << "\ntraffic_event_count_: " << p.event_count;
+            << "\ntraffic_event_count_: " << p.event_count
+            << "\nflows: " << p.flows.size();
   // clang-format on
 }
 
@@ -103,7 +108,9 @@ std::ostream &operator<<(std::ostream &os, const Parameters::Movement &p) {
             << "\nmove_end: " << p.end
             << "\nstep_period: " << p.step_period
             << "\nspeed_range: " << p.speed_range << "m/sp.s"
-            << "\npause_interval: " << p.pause_range;
+            << "\npause_interval: " << p.pause_range
+            << "\nlazy_positions: " << p.lazy_positions
+            << "\ntrace: " << p.trace;
   // clang-format on
 }
 
@@ -135,7 +142,26 @@ std::ostream &operator<<(std::ostream &os, const Parameters::Sarp &p) {
             << "\ncompact_treshold: " << p.compact_treshold
             << "\nupdate_treshold: " << p.update_treshold
             << "\npercentage_variance_treshold: " << p.ratio_variance_treshold
-            << "\nmin_standard_deviation: " << p.min_standard_deviation;
+            << "\nmin_standard_deviation: " << p.min_standard_deviation
+            << "\ndigest_exchange: " << p.digest_exchange
+            << "\ndigest_history: " << p.digest_history
+            << "\ndigest_cost_quantum: " << p.digest_cost_quantum;
+  // clang-format on
+}
+
+void Parameters::Sarp::PrintDigestCsvHeader(std::ostream &os) {
+  // clang-format off
+  os << "digest_exchange" << ','
+     << "digest_history" << ','
+     << "digest_cost_quantum" << ',';
+  // clang-format on
+}
+
+void Parameters::Sarp::PrintDigestCsv(std::ostream &os) const {
+  // clang-format off
+  os << digest_exchange << ','
+     << digest_history << ','
+     << digest_cost_quantum << ',';
   // clang-format on
 }
 
@@ -165,6 +191,15 @@ void Parameters::PrintCsv(std::ostream &os) const {
   sarp_parameters_.second.PrintCsv(os);
 }
 
+void Parameters::PrintSarpCsvHeader(std::ostream &os) {
+  Parameters::Sarp::PrintDigestCsvHeader(os);
+}
+
+void Parameters::PrintSarpCsv(std::ostream &os) const {
+  assert(has_sarp());
+  sarp_parameters_.second.PrintDigestCsv(os);
+}
+
 std::ostream &operator<<(std::ostream &os, const Parameters &p) {
   os << "SIMULATION PARAMETERS\n";
   if (p.has_general()) {
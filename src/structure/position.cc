@@ -23,6 +23,29 @@ double Position::Distance(const Position &pos1, const Position &pos2) {
   return std::sqrt(dx * dx + dy * dy + dz * dz);
 }
 
+int64_t Position::DistanceSquared(const Position &pos1, const Position &pos2) {
+  int64_t dx = pos1.x - pos2.x;
+  int64_t dy = pos1.y - pos2.y;
+  int64_t dz = pos1.z - pos2.z;
+  return dx * dx + dy * dy + dz * dz;
+}
+
+// Spreads lower 21 bits of value so that there are two zero bits between each
+// of them.
+static uint64_t SpreadBits(uint64_t value) {
+  value &= 0x1fffff;
+  value = (value | value << 32) & 0x001f00000000ffff;
+  value = (value | value << 16) & 0x001f0000ff0000ff;
+  value = (value | value << 8) & 0x100f00f00f00f00f;
+  value = (value | value << 4) & 0x10c30c30c30c30c3;
+  value = (value | value << 2) & 0x1249249249249249;
+  return value;
+}
+
+uint64_t MortonCode(uint64_t x, uint64_t y, uint64_t z) {
+  return SpreadBits(x) | SpreadBits(y) << 1 | SpreadBits(z) << 2;
+}
+
 bool Position::operator==(const Position &other) const {
   return x == other.x && y == other.y && z == other.z;
 }
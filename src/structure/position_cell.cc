@@ -0,0 +1,173 @@
+//
+// position_cell.cc
+//
+
+#include "structure/position_cell.h"
+
+#include <algorithm>
+#include <cassert>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+namespace simulation {
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+// Vector paths compute squared distances in 32 bit lanes. Axis differences
+// are clamped to this value so that a sum of three squares never overflows.
+// Clamped candidates are always out of range as long as squared_limit does
+// not exceed kMaxAxisDelta^2, otherwise the plain loop is used.
+constexpr int kMaxAxisDelta = 26754;
+constexpr int64_t kMaxVectorLimit =
+    static_cast<int64_t>(kMaxAxisDelta) * kMaxAxisDelta;
+#endif
+
+static std::size_t FilterInRangeScalar(const Position &position,
+                                       int64_t squared_limit, const int *xs,
+                                       const int *ys, const int *zs,
+                                       std::size_t begin, std::size_t count,
+                                       uint32_t *matches) {
+  std::size_t found = 0;
+  for (std::size_t i = begin; i < count; ++i) {
+    int64_t dx = position.x - xs[i];
+    int64_t dy = position.y - ys[i];
+    int64_t dz = position.z - zs[i];
+    if (dx * dx + dy * dy + dz * dz < squared_limit) {
+      matches[found++] = i;
+    }
+  }
+  return found;
+}
+
+#if defined(__AVX2__)
+static std::size_t FilterInRangeVector(const Position &position,
+                                       int64_t squared_limit, const int *xs,
+                                       const int *ys, const int *zs,
+                                       std::size_t count, uint32_t *matches) {
+  const __m256i px = _mm256_set1_epi32(position.x);
+  const __m256i py = _mm256_set1_epi32(position.y);
+  const __m256i pz = _mm256_set1_epi32(position.z);
+  const __m256i max_delta = _mm256_set1_epi32(kMaxAxisDelta);
+  const __m256i limit = _mm256_set1_epi32(static_cast<int>(squared_limit));
+  auto SquaredAxis = [&max_delta](__m256i p, const int *c) {
+    __m256i d = _mm256_sub_epi32(
+        p, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(c)));
+    d = _mm256_min_epi32(_mm256_abs_epi32(d), max_delta);
+    return _mm256_mullo_epi32(d, d);
+  };
+  std::size_t found = 0;
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i d2 = _mm256_add_epi32(
+        _mm256_add_epi32(SquaredAxis(px, xs + i), SquaredAxis(py, ys + i)),
+        SquaredAxis(pz, zs + i));
+    unsigned mask = _mm256_movemask_ps(
+        _mm256_castsi256_ps(_mm256_cmpgt_epi32(limit, d2)));
+    while (mask) {
+      matches[found++] = i + __builtin_ctz(mask);
+      mask &= mask - 1;
+    }
+  }
+  return found + FilterInRangeScalar(position, squared_limit, xs, ys, zs, i,
+                                     count, matches + found);
+}
+#elif defined(__SSE4_1__)
+static std::size_t FilterInRangeVector(const Position &position,
+                                       int64_t squared_limit, const int *xs,
+                                       const int *ys, const int *zs,
+                                       std::size_t count, uint32_t *matches) {
+  const __m128i px = _mm_set1_epi32(position.x);
+  const __m128i py = _mm_set1_epi32(position.y);
+  const __m128i pz = _mm_set1_epi32(position.z);
+  const __m128i max_delta = _mm_set1_epi32(kMaxAxisDelta);
+  const __m128i limit = _mm_set1_epi32(static_cast<int>(squared_limit));
+  auto SquaredAxis = [&max_delta](__m128i p, const int *c) {
+    __m128i d =
+        _mm_sub_epi32(p, _mm_loadu_si128(reinterpret_cast<const __m128i *>(c)));
+    d = _mm_min_epi32(_mm_abs_epi32(d), max_delta);
+    return _mm_mullo_epi32(d, d);
+  };
+  std::size_t found = 0;
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i d2 = _mm_add_epi32(
+        _mm_add_epi32(SquaredAxis(px, xs + i), SquaredAxis(py, ys + i)),
+        SquaredAxis(pz, zs + i));
+    unsigned mask =
+        _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(limit, d2)));
+    while (mask) {
+      matches[found++] = i + __builtin_ctz(mask);
+      mask &= mask - 1;
+    }
+  }
+  return found + FilterInRangeScalar(position, squared_limit, xs, ys, zs, i,
+                                     count, matches + found);
+}
+#endif
+
+std::size_t FilterInRange(const Position &position, int64_t squared_limit,
+                          const int *xs, const int *ys, const int *zs,
+                          std::size_t count, uint32_t *matches) {
+#if defined(__AVX2__) || defined(__SSE4_1__)
+  if (squared_limit <= kMaxVectorLimit) {
+    return FilterInRangeVector(position, squared_limit, xs, ys, zs, count,
+                               matches);
+  }
+#endif
+  return FilterInRangeScalar(position, squared_limit, xs, ys, zs, 0, count,
+                             matches);
+}
+
+void PositionCell::Insert(NodeID node, const Position &position) {
+  assert(IndexOf(node) == nodes_.size());
+  nodes_.push_back(node);
+  x_.push_back(position.x);
+  y_.push_back(position.y);
+  z_.push_back(position.z);
+}
+
+void PositionCell::Erase(NodeID node) {
+  // Order of nodes in the cell is not significant so swap with the last one.
+  std::size_t i = IndexOf(node);
+  assert(i < nodes_.size());
+  nodes_[i] = nodes_.back();
+  x_[i] = x_.back();
+  y_[i] = y_.back();
+  z_[i] = z_.back();
+  nodes_.pop_back();
+  x_.pop_back();
+  y_.pop_back();
+  z_.pop_back();
+}
+
+void PositionCell::Update(NodeID node, const Position &position) {
+  std::size_t i = IndexOf(node);
+  assert(i < nodes_.size());
+  x_[i] = position.x;
+  y_[i] = position.y;
+  z_[i] = position.z;
+}
+
+void PositionCell::CollectInRange(const Position &position,
+                                  int64_t squared_limit,
+                                  std::vector<NodeID> *result) const {
+  // Process the cell in chunks to keep the match buffer on the stack.
+  constexpr std::size_t chunk = 64;
+  uint32_t matches[chunk];
+  for (std::size_t begin = 0; begin < nodes_.size(); begin += chunk) {
+    std::size_t count = std::min(chunk, nodes_.size() - begin);
+    std::size_t found =
+        FilterInRange(position, squared_limit, x_.data() + begin,
+                      y_.data() + begin, z_.data() + begin, count, matches);
+    for (std::size_t i = 0; i < found; ++i) {
+      result->push_back(nodes_[begin + matches[i]]);
+    }
+  }
+}
+
+std::size_t PositionCell::IndexOf(NodeID node) const {
+  return std::find(nodes_.cbegin(), nodes_.cend(), node) - nodes_.cbegin();
+}
+
+}  // namespace simulation
@@ -18,30 +18,14 @@ std::ostream &operator<<(std::ostream &os, const PositionCube &position_cube) {
 PositionCube::PositionCube(uint32_t x, uint32_t y, uint32_t z)
     : x(x), y(y), z(z) {}
 
-PositionCube::PositionCube(const Position &p, uint32_t connection_range) {
-  uint32_t min_cube_side = connection_range;
+PositionCube::PositionCube(const Position &p, uint32_t cell_side) {
+  uint32_t min_cube_side = cell_side;
   assert(min_cube_side != 0);
   x = p.x / min_cube_side;
   y = p.y / min_cube_side;
   z = p.z / min_cube_side;
 }
 
-std::pair<PositionCube, bool> PositionCube::GetRelativeCube(
-    const int relative_pos[3]) const {
-  int signed_x = x;
-  int signed_y = y;
-  int signed_z = z;
-
-  signed_x += relative_pos[0];
-  signed_y += relative_pos[1];
-  signed_z += relative_pos[2];
-
-  if (signed_x < 0 || signed_y < 0 || signed_z < 0) {
-    return std::make_pair(PositionCube(), false);
-  }
-  return std::make_pair(PositionCube(signed_x, signed_y, signed_z), true);
-}
-
 int PositionCube::Distance(const PositionCube &pos1, const PositionCube &pos2) {
   uint32_t dx = std::abs((int)pos1.x - (int)pos2.x);
   uint32_t dy = std::abs((int)pos1.y - (int)pos2.y);
@@ -56,18 +40,41 @@ static std::size_t get_max_cube_side(const Position &min, const Position &max) {
   return std::max(dx, std::max(dy, dz));
 }
 
-std::size_t PositionCube::GetID(Position min_pos, Position max_pos,
-                                uint32_t connection_range) const {
+// WARNING: to keep GetID a 1-universal function for all possible node
+// positions we have to add +2 to max index instead of 1 since some
+// neighboring nodes will coordinate == cube_side / min_cube_side + 1.
+// GetRelativeCube rejects cubes further away, GetID would alias them.
+static int GetMaxIndex(Position min_pos, Position max_pos, uint32_t cell_side) {
   int cube_side = get_max_cube_side(min_pos, max_pos);
-  int min_cube_side = connection_range;
+  int min_cube_side = cell_side;
+  return cube_side / min_cube_side + 2;
+}
 
-  // WARNING: to keep GetID a 1-universal function for all possible node
-  // positions we have to add +2 to max index instead of 1 since some
-  // neighboring nodes will coordinate == cube_side / min_cube_side + 1.
-  int max_index = cube_side / min_cube_side + 2;
+std::size_t PositionCube::GetID(Position min_pos, Position max_pos,
+                                uint32_t cell_side) const {
+  int max_index = GetMaxIndex(min_pos, max_pos, cell_side);
   return x + y * max_index + z * max_index * max_index;
 }
 
+std::pair<PositionCube, bool> PositionCube::GetRelativeCube(
+    const int relative_pos[3], Position min_pos, Position max_pos,
+    uint32_t cell_side) const {
+  const int max_index = GetMaxIndex(min_pos, max_pos, cell_side);
+  const int coordinates[3] = {static_cast<int>(x), static_cast<int>(y),
+                              static_cast<int>(z)};
+  int shifted[3];
+  for (int i = 0; i < 3; ++i) {
+    shifted[i] = coordinates[i] + relative_pos[i];
+    // Cubes of nodes out of the boundaries are kept, only moving past the
+    // grid is rejected.
+    if (shifted[i] < 0 || (relative_pos[i] != 0 && shifted[i] >= max_index)) {
+      return std::make_pair(PositionCube(), false);
+    }
+  }
+  return std::make_pair(PositionCube(shifted[0], shifted[1], shifted[2]),
+                        true);
+}
+
 bool PositionCube::operator==(const PositionCube &other) const {
   return x == other.x && y == other.y && z == other.z;
 }
@@ -10,10 +10,10 @@
 namespace simulation {
 
 std::ostream &operator<<(std::ostream &os, const Routing &r) {
-  return os << "R" << r.node_;
+  return os << "R" << *r.node_;
 }
 
-Routing::Routing(Node &node) : node_(node) {}
+Routing::Routing(Node &node) : node_(&node) {}
 
 Routing::~Routing() {}
 
@@ -33,29 +33,29 @@ void Routing::CheckPeriodicUpdate(Env &env) {
   // Now plan for next update.
   next_update_ = current_time + update_period;
   env.simulation.ScheduleEvent(std::make_unique<UpdateRoutingEvent>(
-      next_update_, TimeType::ABSOLUTE, *this));
+      next_update_, TimeType::ABSOLUTE, node_->get_id()));
 }
 
-void Routing::RequestUpdate(Env &env, Node *neighbor) {
+void Routing::RequestUpdate(Env &env, NodeID neighbor) {
   env.simulation.ScheduleEvent(std::make_unique<RequestUpdateEvent>(
-      1, TimeType::RELATIVE, &node_, neighbor));
+      1, TimeType::RELATIVE, node_->get_id(), neighbor));
 }
 
 void Routing::RequestAllUpdates(Env &env) {
-  for (auto neighbor : node_.get_neighbors()) {
-    if (neighbor == &node_) {
+  for (const auto &link : node_->get_neighbors()) {
+    if (link.id == node_->get_id()) {
       continue;
     }
-    RequestUpdate(env, neighbor);
+    RequestUpdate(env, link.id);
   }
 }
 
-void Routing::NotifyChange() {
-  for (auto neighbor : node_.get_neighbors()) {
-    if (neighbor == &node_) {
+void Routing::NotifyChange(Env &env) {
+  for (const auto &link : node_->get_neighbors()) {
+    if (link.id == node_->get_id()) {
       continue;
     }
-    neighbor->get_routing().change_notified_ = true;
+    env.network->get_node(link.id)->get_routing().change_notified_ = true;
   }
 }
 
@@ -34,6 +34,10 @@ Simulation::CreateScenario(const Parameters &p) {
   if (p.has_traffic()) {
     event_generators.push_back(std::make_unique<RandomTrafficGenerator>(
         p.get_traffic().time_range, *network, p.get_traffic().event_count));
+    if (!p.get_traffic().flows.empty()) {
+      event_generators.push_back(
+          std::make_unique<FlowGenerator>(p.get_traffic().flows, *network));
+    }
   }
   return std::make_pair(std::move(network), std::move(event_generators));
 }
@@ -49,6 +53,7 @@ void Simulation::Run(unsigned seed, Parameters sp, Network &network,
   std::srand(seed);
   Env env;
   env.parameters = std::move(sp);
+  env.network = &network;
   env.stats.Reset();
   env.simulation.InitSchedule(network, events);
   env.simulation.Start(env, network);
@@ -88,6 +93,10 @@ void Simulation::Start(Env &env, Network &network) {
       event->Print(std::cout);
 #endif
       event->Execute(env);
+      if (event->repeat_) {
+        event->repeat_ = false;
+        schedule_.push(std::move(event));
+      }
     }
   }
 #ifndef CSV
@@ -96,6 +105,9 @@ void Simulation::Start(Env &env, Network &network) {
 
 #ifdef CSV
   env.parameters.PrintCsv(std::cout);
+  if (env.parameters.has_sarp()) {
+    env.parameters.PrintSarpCsv(std::cout);
+  }
   env.stats.PrintCsv(std::cout, network);
 #else
   std::cout << env.parameters;
@@ -0,0 +1,84 @@
+//
+// thread_pool.cc
+//
+
+#include "structure/thread_pool.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace simulation {
+
+ThreadPool::ThreadPool(unsigned thread_count) {
+  assert(thread_count > 0);
+  for (unsigned i = 1; i < thread_count; ++i) {
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  job_ready_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::ParallelFor(std::size_t count, const Task &task) {
+  if (count == 0) {
+    return;
+  }
+  if (workers_.empty()) {
+    task(0, count);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    count_ = count;
+    // Several chunks per thread so that uneven chunks get balanced.
+    chunk_ = std::max<std::size_t>(1, count / (get_thread_count() * 8));
+    next_ = 0;
+    busy_workers_ = workers_.size();
+    ++job_id_;
+  }
+  job_ready_.notify_all();
+  RunChunks();
+  std::unique_lock<std::mutex> lock(mutex_);
+  job_done_.wait(lock, [this] { return busy_workers_ == 0; });
+  task_ = nullptr;
+}
+
+void ThreadPool::WorkerLoop() {
+  std::size_t last_job_id = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      job_ready_.wait(lock, [this, last_job_id] {
+        return stop_ || job_id_ != last_job_id;
+      });
+      if (stop_) {
+        return;
+      }
+      last_job_id = job_id_;
+    }
+    RunChunks();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --busy_workers_;
+    }
+    job_done_.notify_one();
+  }
+}
+
+void ThreadPool::RunChunks() {
+  for (std::size_t begin = next_.fetch_add(chunk_); begin < count_;
+       begin = next_.fetch_add(chunk_)) {
+    (*task_)(begin, std::min(begin + chunk_, count_));
+  }
+}
+
+}  // namespace simulation
@@ -0,0 +1,227 @@
+//
+// topology.cc
+//
+
+#include "structure/topology.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+
+#include "structure/mapped_file.h"
+
+namespace simulation {
+
+static constexpr char CSR_MAGIC[8] = {'S', 'A', 'R', 'P', 'C', 'S', 'R', '1'};
+
+// Parses unsigned number preceded by spaces or tabs.
+// RETURNS: false if there is none or it is bigger than max.
+static bool ParseNumber(std::string_view line, std::size_t *i, uint64_t max,
+                        uint64_t *number) {
+  while (*i < line.size() && (line[*i] == ' ' || line[*i] == '\t')) {
+    ++*i;
+  }
+  if (*i >= line.size() || line[*i] < '0' || line[*i] > '9') {
+    return false;
+  }
+  *number = 0;
+  while (*i < line.size() && line[*i] >= '0' && line[*i] <= '9') {
+    const uint64_t digit = line[(*i)++] - '0';
+    if (digit > max || *number > (max - digit) / 10) {
+      return false;
+    }
+    *number = *number * 10 + digit;
+  }
+  return true;
+}
+
+// Compares links by neighbor id.
+static bool LinkLess(const Topology::Link &lhs, const Topology::Link &rhs) {
+  return lhs.id < rhs.id;
+}
+
+std::unique_ptr<Topology> Topology::FromEdgeList(const std::string &path,
+                                                std::size_t node_count) {
+  if (node_count > std::size_t(std::numeric_limits<NodeID>::max()) + 1) {
+    throw std::out_of_range("Node count does not fit NodeID");
+  }
+  MappedFile file(path);
+  std::string_view text = file.get_view();
+  auto topology = std::make_unique<Topology>(node_count);
+  auto &links = topology->links_;
+  // Ids are parsed up to node_count so they can not overflow.
+  const uint64_t max_id = node_count - 1;
+  for (std::size_t line_number = 1; !text.empty(); ++line_number) {
+    std::size_t line_end = text.find('\n');
+    std::string_view line = text.substr(0, line_end);
+    text.remove_prefix(line_end == std::string_view::npos ? text.size()
+                                                          : line_end + 1);
+    std::size_t i = 0;
+    while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) {
+      ++i;
+    }
+    if (i >= line.size() || line[i] < '0' || line[i] > '9') {
+      continue;
+    }
+    uint64_t node1, node2, duration;
+    if (node_count == 0 || !ParseNumber(line, &i, max_id, &node1) ||
+        !ParseNumber(line, &i, max_id, &node2)) {
+      throw std::runtime_error(path + ':' + std::to_string(line_number) +
+                               ": expected two node ids less than " +
+                               std::to_string(node_count));
+    }
+    if (node1 == node2) {
+      continue;
+    }
+    if (!ParseNumber(line, &i, std::numeric_limits<Time>::max(), &duration)) {
+      duration = DEFAULT_DELIVERY_DURATION;
+    }
+    links[node1].push_back(
+        {.id = NodeID(node2), .delivery_duration = duration});
+    links[node2].push_back(
+        {.id = NodeID(node1), .delivery_duration = duration});
+  }
+  // Sort once all links are known, stable sort keeps the first duplicate.
+  for (auto &node_links : links) {
+    std::stable_sort(node_links.begin(), node_links.end(), LinkLess);
+    node_links.erase(std::unique(node_links.begin(), node_links.end(),
+                                 [](const Link &lhs, const Link &rhs) {
+                                   return lhs.id == rhs.id;
+                                 }),
+                     node_links.end());
+  }
+  return topology;
+}
+
+std::unique_ptr<Topology> Topology::FromBinaryCsr(const std::string &path) {
+  MappedFile file(path);
+  std::string_view data = file.get_view();
+  auto topology = std::make_unique<Topology>();
+  uint64_t counts[2];
+  constexpr std::size_t header_size = sizeof(CSR_MAGIC) + sizeof(counts);
+  if (data.size() < header_size ||
+      data.substr(0, sizeof(CSR_MAGIC)) !=
+          std::string_view(CSR_MAGIC, sizeof(CSR_MAGIC))) {
+    return topology;
+  }
+  std::memcpy(counts, data.data() + sizeof(CSR_MAGIC), sizeof(counts));
+  const auto [node_count, link_count] = counts;
+  if (node_count >= data.size() || link_count >= data.size() ||
+      data.size() - header_size != (node_count + 1) * sizeof(uint64_t) +
+                                       link_count * 2 * sizeof(uint32_t)) {
+    return topology;
+  }
+  std::vector<uint64_t> offsets(node_count + 1);
+  std::vector<uint32_t> neighbors(link_count);
+  std::vector<uint32_t> durations(link_count);
+  const char *read = data.data() + header_size;
+  auto Read = [&read](auto &values) {
+    const std::size_t size = values.size() * sizeof(values[0]);
+    if (size > 0) {
+      std::memcpy(values.data(), read, size);
+      read += size;
+    }
+  };
+  Read(offsets);
+  Read(neighbors);
+  Read(durations);
+  topology->links_.resize(node_count);
+  for (std::size_t node = 0; node < node_count; ++node) {
+    if (offsets[node] > offsets[node + 1] || offsets[node + 1] > link_count) {
+      topology->links_.clear();
+      break;
+    }
+    auto &node_links = topology->links_[node];
+    node_links.reserve(offsets[node + 1] - offsets[node]);
+    for (uint64_t i = offsets[node]; i < offsets[node + 1]; ++i) {
+      if (neighbors[i] >= node_count) {
+        topology->links_.clear();
+        return topology;
+      }
+      node_links.push_back(
+          {.id = neighbors[i], .delivery_duration = durations[i]});
+    }
+    assert(std::is_sorted(node_links.begin(), node_links.end(), LinkLess));
+  }
+  return topology;
+}
+
+bool Topology::WriteBinaryCsr(const std::string &path) const {
+  std::vector<uint64_t> offsets = {0};
+  std::vector<uint32_t> neighbors;
+  std::vector<uint32_t> durations;
+  for (const auto &node_links : links_) {
+    for (const Link &link : node_links) {
+      neighbors.push_back(link.id);
+      durations.push_back(link.delivery_duration);
+    }
+    offsets.push_back(neighbors.size());
+  }
+  const uint64_t counts[2] = {links_.size(), neighbors.size()};
+  std::ofstream os(path, std::ios::binary);
+  os.write(CSR_MAGIC, sizeof(CSR_MAGIC));
+  os.write(reinterpret_cast<const char *>(counts), sizeof(counts));
+  os.write(reinterpret_cast<const char *>(offsets.data()),
+           offsets.size() * sizeof(uint64_t));
+  os.write(reinterpret_cast<const char *>(neighbors.data()),
+           neighbors.size() * sizeof(uint32_t));
+  os.write(reinterpret_cast<const char *>(durations.data()),
+           durations.size() * sizeof(uint32_t));
+  return static_cast<bool>(os);
+}
+
+void Topology::AddLink(NodeID node1, NodeID node2, Time delivery_duration) {
+  assert(node1 != node2);
+  if (std::max(node1, node2) >= links_.size()) {
+    throw std::out_of_range("Link of node " +
+                            std::to_string(std::max(node1, node2)) +
+                            " which is not in the topology");
+  }
+  auto Add = [this, delivery_duration](NodeID node, NodeID neighbor) {
+    auto &node_links = links_[node];
+    const Link link = {.id = neighbor, .delivery_duration = delivery_duration};
+    auto it = std::lower_bound(node_links.begin(), node_links.end(), link,
+                               LinkLess);
+    if (it != node_links.end() && it->id == neighbor) {
+      it->delivery_duration = delivery_duration;
+    } else {
+      node_links.insert(it, link);
+    }
+  };
+  Add(node1, node2);
+  Add(node2, node1);
+}
+
+void Topology::RemoveLink(NodeID node1, NodeID node2) {
+  auto Remove = [this](NodeID node, NodeID neighbor) {
+    if (node >= links_.size()) {
+      return;
+    }
+    auto &node_links = links_[node];
+    auto it = std::lower_bound(node_links.begin(), node_links.end(),
+                               Link{.id = neighbor}, LinkLess);
+    if (it != node_links.end() && it->id == neighbor) {
+      node_links.erase(it);
+    }
+  };
+  Remove(node1, node2);
+  Remove(node2, node1);
+}
+
+const Topology::Link *Topology::FindLink(NodeID node, NodeID neighbor) const {
+  const auto &node_links = get_links(node);
+  auto it = std::lower_bound(node_links.begin(), node_links.end(),
+                             Link{.id = neighbor}, LinkLess);
+  return (it != node_links.end() && it->id == neighbor) ? &*it : nullptr;
+}
+
+const std::vector<Topology::Link> &Topology::get_links(NodeID node) const {
+  static const std::vector<Link> no_links;
+  return node < links_.size() ? links_[node] : no_links;
+}
+
+}  // namespace simulation
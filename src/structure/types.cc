@@ -8,17 +8,6 @@
 
 namespace simulation {
 
-std::ostream &operator<<(std::ostream &os, const Address &addr) {
-  os << '[';
-
-  char delim = 0;
-  for (const auto &addr_component : addr) {
-    os << delim << (unsigned)addr_component;
-    delim = '.';
-  }
-  return os << ']';
-}
-
 std::ostream &operator<<(std::ostream &os, const RoutingType &r) {
   switch (r) {
     case RoutingType::DISTANCE_VECTOR: